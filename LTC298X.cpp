@@ -1,173 +1,936 @@
 #include "LTC298X.h"
+#include "LTC298XConfig.h"
+#if LTC298X_INSTRUMENTATION && defined(__AVR__)
+#include <util/atomic.h>
+#endif
 
 // PRIVATE
 
 /*
- * SPI helper-functions
- */
-void LTC298X::beginTransaction(void) {
-	SPI.beginTransaction(SPISettings(2000000, MSBFIRST, SPI_MODE0));
-	digitalWrite(_cs, LOW);
-}
-void LTC298X::endTransaction(void) {
-	SPI.endTransaction();
-	digitalWrite(_cs, HIGH);
-}
-void LTC298X::write8(uint16_t addr, uint8_t data) {
-	this->beginTransaction();
-	SPI.transfer(LTC298X_SPI_WRITE);
-	SPI.transfer16(addr);
-	SPI.transfer(data);
-	this->endTransaction();
-}
-uint8_t LTC298X::read8(uint16_t addr) {
-	this->beginTransaction();
-	SPI.transfer(LTC298X_SPI_READ);
-	SPI.transfer16(addr);
-	uint8_t val = SPI.transfer(0);
-	this->endTransaction();
-	return val;
+ * Interrupt handlers can't be bound to an instance, so each attached device gets its own trampoline.
+ */
+static LTC298XDevice* irq_devices[LTC298X_MAX_IRQ_DEVICES];
+static void irq0(void) { irq_devices[0]->handleInterrupt(); }
+static void irq1(void) { irq_devices[1]->handleInterrupt(); }
+static void irq2(void) { irq_devices[2]->handleInterrupt(); }
+static void irq3(void) { irq_devices[3]->handleInterrupt(); }
+static void (*const irq_handlers[LTC298X_MAX_IRQ_DEVICES])(void) = {irq0, irq1, irq2, irq3};
+
+/*
+ * Extract the signed 24 bit value of a result word
+ */
+static int32_t resultValue(uint32_t val) {
+	int32_t fp = val & 0xFFFFFF; //extract relevant bits
+	if (fp & 0x800000) fp |= 0xFF000000; //convert from 24bit signed to 32bit signed
+	return fp;
 }
-void LTC298X::write24(uint16_t addr, uint32_t data) {
-	this->beginTransaction();
-	SPI.transfer(LTC298X_SPI_WRITE);
-	SPI.transfer16(addr);
-	SPI.transfer16(data >> 8);
-	SPI.transfer(data & 0xFF);
-	this->endTransaction();
-}
-uint32_t LTC298X::read24(uint16_t addr) {
-	this->beginTransaction();
-	SPI.transfer(LTC298X_SPI_READ);
-	SPI.transfer16(addr);
-	uint32_t val = (uint32_t)SPI.transfer16(0) << 8;
-	val |= SPI.transfer(0);
-	this->endTransaction();
-	return val;
+/*
+ * CRC-16/CCITT, used to find identical custom tables
+ */
+static uint16_t crc16(uint16_t crc, const uint8_t* buf, uint8_t len) {
+	for (uint8_t i = 0; i < len; i++) {
+		crc ^= (uint16_t)buf[i] << 8;
+		for (uint8_t j = 0; j < 8; j++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+/*
+ * Block transfers. The LTC298X auto-increments the address while CS is held LOW,
+ * so any contiguous register range can be moved with a single instruction/address header.
+ */
+void LTC298XDevice::writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len) {
+	uint8_t header[3] = {LTC298X_SPI_WRITE, (uint8_t)(addr >> 8), (uint8_t)addr};
+	_bus->beginTransaction();
+	_bus->transfer(header, NULL, 3);
+	_bus->transfer(buf, NULL, len);
+	_bus->endTransaction();
+	this->countTransaction(3 + len);
+}
+void LTC298XDevice::readBlock(uint16_t addr, uint8_t* buf, uint16_t len) {
+	uint8_t header[3] = {LTC298X_SPI_READ, (uint8_t)(addr >> 8), (uint8_t)addr};
+	_bus->beginTransaction();
+	_bus->transfer(header, NULL, 3);
+	_bus->transfer(NULL, buf, len);
+	_bus->endTransaction();
+	this->countTransaction(3 + len);
+}
+/*
+ * Register helpers, all values are transmitted MSB first.
+ */
+void LTC298XDevice::write8(uint16_t addr, uint8_t data) {
+	this->writeBlock(addr, &data, 1);
 }
-void LTC298X::write32(uint16_t addr, uint32_t data) {
-	this->beginTransaction();
-	SPI.transfer(LTC298X_SPI_WRITE);
-	SPI.transfer16(addr);
-	SPI.transfer16(data >> 16);
-	SPI.transfer16(data & 0xFFFF);
-	this->endTransaction();
-}
-uint32_t LTC298X::read32(uint16_t addr) {
-	this->beginTransaction();
-	SPI.transfer(LTC298X_SPI_READ);
-	SPI.transfer16(addr);
-	uint32_t val = SPI.transfer16(0);
-	val <<= 16;
-	val |= SPI.transfer16(0);
-	this->endTransaction();
+uint8_t LTC298XDevice::read8(uint16_t addr) {
+	uint8_t val;
+	this->readBlock(addr, &val, 1);
 	return val;
 }
+void LTC298XDevice::write24(uint16_t addr, uint32_t data) {
+	uint8_t buf[3] = {(uint8_t)(data >> 16), (uint8_t)(data >> 8), (uint8_t)data};
+	this->writeBlock(addr, buf, 3);
+}
+uint32_t LTC298XDevice::read24(uint16_t addr) {
+	uint8_t buf[3];
+	this->readBlock(addr, buf, 3);
+	return (uint32_t)buf[0] << 16 | (uint32_t)buf[1] << 8 | buf[2];
+}
+void LTC298XDevice::write32(uint16_t addr, uint32_t data) {
+	uint8_t buf[4] = {(uint8_t)(data >> 24), (uint8_t)(data >> 16), (uint8_t)(data >> 8), (uint8_t)data};
+	this->writeBlock(addr, buf, 4);
+}
+uint32_t LTC298XDevice::read32(uint16_t addr) {
+	uint8_t buf[4];
+	this->readBlock(addr, buf, 4);
+	return (uint32_t)buf[0] << 24 | (uint32_t)buf[1] << 16 | (uint32_t)buf[2] << 8 | buf[3];
+}
+/*
+ * Write-through helpers for the shadowed registers.
+ * The chip is only read if the shadow copy is not valid and only written if the value changes.
+ */
+void LTC298XDevice::writeGlobal(uint8_t clear, uint8_t set) {
+	if (!(_cache_valid & LTC298X_CACHE_GLOB)) {
+		_glob = this->read8(LTC298X_ADDR_CONFIG_GLOB);
+		_cache_valid |= LTC298X_CACHE_GLOB;
+	}
+	uint8_t val = (_glob & ~clear) | set;
+	if (val == _glob) return; //unchanged
+	this->write8(LTC298X_ADDR_CONFIG_GLOB, val);
+	_glob = val;
+}
+void LTC298XDevice::writeChannel(uint8_t ch, uint32_t config) {
+	this->releaseTable(ch);
+	this->storeChannel(ch, config);
+}
+void LTC298XDevice::storeChannel(uint8_t ch, uint32_t config) {
+	uint32_t bit = (uint32_t)1 << (ch - 1);
+	if ((_cache_valid & bit) && _ch[ch - 1] == config) return; //unchanged
+	if (_staging) _dirty |= bit; //written on commitConfig()
+	else this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, config);
+	_ch[ch - 1] = config;
+	_cache_valid |= bit;
+}
+
+/*
+ * Custom RAM uploads. With LTC298X_RAM_SHADOW enabled, a copy of the custom RAM is kept locally
+ * and only bytes that differ from it are written, close runs of changed bytes are joined to one burst.
+ * Otherwise the data is sent as a single burst, placeTable() only skips tables with an unchanged CRC.
+ */
+#if LTC298X_RAM_SHADOW
+void LTC298XDevice::deltaByte(uint16_t offset, uint8_t data, uint16_t* run, uint16_t* run_end) {
+	uint8_t bit = 1 << (offset & 7);
+	if ((_ram_valid[offset >> 3] & bit) && _ram[offset] == data) {
+		//unchanged, close the pending run if the gap gets more expensive than a new header
+		if (*run != 0xFFFF && offset - *run_end > LTC298X_DELTA_MAX_GAP) {
+			this->writeBlock(LTC298X_ADDR_RAM_START + *run, _ram + *run, *run_end - *run + 1);
+			*run = 0xFFFF;
+		}
+		return;
+	}
+	_ram[offset] = data;
+	_ram_valid[offset >> 3] |= bit;
+	if (*run == 0xFFFF) *run = offset;
+	*run_end = offset;
+}
+#endif
+void LTC298XDevice::writeRam(uint16_t offset, const uint8_t* buf, uint16_t len) {
+#if LTC298X_RAM_SHADOW
+	uint16_t run = 0xFFFF;
+	uint16_t run_end = 0;
+	for (uint16_t i = 0; i < len; i++) this->deltaByte(offset + i, buf[i], &run, &run_end);
+	if (run != 0xFFFF) this->writeBlock(LTC298X_ADDR_RAM_START + run, _ram + run, run_end - run + 1);
+#else
+	this->writeBlock(LTC298X_ADDR_RAM_START + offset, buf, len);
+#endif
+}
+void LTC298XDevice::readRam(uint16_t offset, uint8_t* buf, uint16_t len) {
+#if LTC298X_RAM_SHADOW
+	bool known = true;
+	for (uint16_t i = offset; i < offset + len && known; i++) known = _ram_valid[i >> 3] & (1 << (i & 7));
+	if (known) {
+		memcpy(buf, _ram + offset, len);
+		return;
+	}
+	this->readBlock(LTC298X_ADDR_RAM_START + offset, buf, len);
+	for (uint16_t i = 0; i < len; i++) {
+		_ram[offset + i] = buf[i];
+		_ram_valid[(offset + i) >> 3] |= 1 << ((offset + i) & 7);
+	}
+#else
+	this->readBlock(LTC298X_ADDR_RAM_START + offset, buf, len);
+#endif
+}
+/*
+ * Row i of a custom table.
+ * x is saved as 24 bit fixed point fraction with x_scale = 2^fraction bits, kelvin as 14,10 fixed point fraction.
+ */
+static void tableRow(const double* x, double x_scale, const double* kelvin, uint8_t i, uint8_t* row) {
+	uint32_t fp_x = (uint32_t)(int32_t)(x[i] * x_scale);
+	uint32_t fp_kelvin = (uint32_t)(kelvin[i] * 1024);
+	row[0] = fp_x >> 16;
+	row[1] = fp_x >> 8;
+	row[2] = fp_x;
+	row[3] = fp_kelvin >> 16;
+	row[4] = fp_kelvin >> 8;
+	row[5] = fp_kelvin;
+}
+#define TABLE_ROW(data, i, row) \
+	if ((data).buf) memcpy(row, (data).buf + (i) * 6, 6); \
+	else tableRow((data).x, (data).x_scale, (data).kelvin, i, row)
+/*
+ * Encode and upload a custom table at offset (in byte)
+ */
+void LTC298XDevice::uploadTable(uint16_t offset, const TableData& data) {
+#if LTC298X_RAM_SHADOW
+	uint16_t run = 0xFFFF;
+	uint16_t run_end = 0;
+#else
+	uint16_t addr = LTC298X_ADDR_RAM_START + offset;
+	uint8_t header[3] = {LTC298X_SPI_WRITE, (uint8_t)(addr >> 8), (uint8_t)addr};
+	_bus->beginTransaction();
+	_bus->transfer(header, NULL, 3);
+#endif
+	for (uint8_t i = 0; i < data.rows; i++) {
+		uint8_t row[6];
+		TABLE_ROW(data, i, row);
+#if LTC298X_RAM_SHADOW
+		for (uint8_t j = 0; j < 6; j++) this->deltaByte(offset + i * 6 + j, row[j], &run, &run_end);
+#else
+		_bus->transfer(row, NULL, 6);
+#endif
+	}
+#if LTC298X_RAM_SHADOW
+	if (run != 0xFFFF) this->writeBlock(LTC298X_ADDR_RAM_START + run, _ram + run, run_end - run + 1);
+#else
+	_bus->endTransaction();
+	this->countTransaction(3 + data.rows * 6);
+#endif
+}
+
+/*
+ * Custom RAM allocator.
+ * Tables are placed at 4 byte aligned offsets, identical tables are shared by all channels using them
+ * and found by hash first, then compared byte by byte. Each channel word referencing a table holds one reference,
+ * the space is free again once the last channel is reassigned. If the free space is fragmented,
+ * live tables are moved to the start of the RAM and their channel words are rewritten.
+ */
+uint16_t LTC298XDevice::tableHash(uint8_t t) {
+	if (_tables[t].hashed) return _tables[t].hash;
+	uint16_t len = _tables[t].words * 4;
+	len -= len % 6; //an odd number of rows leaves 2 byte padding
+	uint16_t crc = 0xFFFF;
+	uint8_t chunk[24];
+	for (uint16_t i = 0; i < len; i += sizeof(chunk)) {
+		uint8_t n = len - i < (uint16_t)sizeof(chunk) ? len - i : sizeof(chunk);
+		this->readRam(_tables[t].start * 4 + i, chunk, n);
+		crc = crc16(crc, chunk, n);
+	}
+	_tables[t].hash = crc;
+	_tables[t].hashed = true;
+	return crc;
+}
+bool LTC298XDevice::sameTable(uint8_t t, const TableData& data) {
+	uint8_t chunk[24]; //4 rows
+	for (uint8_t i = 0; i < data.rows; i += 4) {
+		uint8_t n = data.rows - i < 4 ? data.rows - i : 4;
+		this->readRam(_tables[t].start * 4 + i * 6, chunk, n * 6);
+		for (uint8_t j = 0; j < n; j++) {
+			uint8_t row[6];
+			TABLE_ROW(data, i + j, row);
+			if (memcmp(row, chunk + j * 6, 6)) return false;
+		}
+	}
+	return true;
+}
+bool LTC298XDevice::rangeFree(uint16_t start, uint8_t words) {
+	if (start > LTC298X_MAX_ADDR_OFFSET || start + words > LTC298X_RAM_WORDS) return false;
+	for (uint8_t t = 0; t < LTC298X_MAX_TABLES; t++) {
+		if (!_tables[t].refs) continue;
+		if (start < _tables[t].start + _tables[t].words && _tables[t].start < start + words) return false; //overlap
+	}
+	if (!_staging) return true;
+	for (uint16_t w = start; w < start + words; w++) {
+		if (_pinned[w >> 3] & (1 << (w & 7))) return false; //still used by a committed channel word
+	}
+	return true;
+}
+/*
+ * Find or place a table for ch, releasing its previous table first.
+ * Returns the table index or LTC298X_MAX_TABLES if it does not fit, the previous table is kept then.
+ */
+uint8_t LTC298XDevice::placeTable(uint8_t ch, const TableData& data, uint16_t start_addr_offset) {
+	uint8_t words = (data.rows * 6 + 3) / 4;
+	uint16_t crc = 0xFFFF;
+	for (uint8_t i = 0; i < data.rows; i++) {
+		uint8_t row[6];
+		TABLE_ROW(data, i, row);
+		crc = crc16(crc, row, 6);
+	}
+	uint8_t old = _table_of[ch - 1];
+#if !LTC298X_RAM_SHADOW
+	//without a copy of the RAM the hash stands in for the content, an unchanged table of this channel is not uploaded again
+	if (old &&
+	    _tables[old - 1].refs == 1 &&
+	    _tables[old - 1].words == words &&
+	    _tables[old - 1].hashed &&
+	    _tables[old - 1].hash == crc &&
+	    (start_addr_offset == LTC298X_AUTO_ADDR || start_addr_offset == _tables[old - 1].start)
+	) {
+		this->releaseTable(ch);
+		return old - 1;
+	}
+#endif
+	this->releaseTable(ch);
+	//share an identical table
+	for (uint8_t t = 0; t < LTC298X_MAX_TABLES; t++) {
+		if (!_tables[t].refs || _tables[t].words != words) continue;
+		if (start_addr_offset != LTC298X_AUTO_ADDR && _tables[t].start != start_addr_offset) continue;
+		if (this->tableHash(t) == crc && this->sameTable(t, data)) return t;
+	}
+	uint16_t start = start_addr_offset;
+	if (start == LTC298X_AUTO_ADDR) {
+		//reuse the previous place of this channel, so an updated table only uploads changed bytes
+		if (old && this->rangeFree(_tables[old - 1].start, words)) start = _tables[old - 1].start;
+		for (uint8_t pass = 0; pass < 2 && start == LTC298X_AUTO_ADDR; pass++) {
+			for (uint8_t s = 0; s <= LTC298X_MAX_ADDR_OFFSET; s++) {
+				if (!this->rangeFree(s, words)) continue;
+				start = s;
+				break;
+			}
+			if (start == LTC298X_AUTO_ADDR && !pass && !_staging && this->freeRam() >= words * 4) this->compactRam();
+		}
+	} else if (!this->rangeFree(start, words)) {
+		start = LTC298X_AUTO_ADDR;
+	}
+	uint8_t t = 0;
+	while (t < LTC298X_MAX_TABLES && _tables[t].refs) t++;
+	if (start == LTC298X_AUTO_ADDR || t == LTC298X_MAX_TABLES) {
+		if (old) this->bindTable(ch, old - 1); //keep the previous table
+		return LTC298X_MAX_TABLES;
+	}
+	_tables[t].start = start;
+	_tables[t].words = words;
+	_tables[t].hash = crc;
+	_tables[t].hashed = true;
+	this->uploadTable(start * 4, data);
+	return t;
+}
+void LTC298XDevice::bindTable(uint8_t ch, uint8_t t) {
+	_tables[t].refs++;
+	_table_of[ch - 1] = t + 1;
+}
+void LTC298XDevice::releaseTable(uint8_t ch) {
+	if (!_table_of[ch - 1]) return;
+	_tables[_table_of[ch - 1] - 1].refs--;
+	_table_of[ch - 1] = 0;
+}
+/*
+ * Rebuild the allocation from the shadowed channel words after they were loaded as a whole
+ */
+void LTC298XDevice::rebuildTables(void) {
+	memset(_tables, 0, sizeof(_tables));
+	memset(_table_of, 0, sizeof(_table_of));
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(_cache_valid & ((uint32_t)1 << i))) continue;
+		uint16_t end = this->tableEnd(_ch[i]);
+		if (!end) continue;
+		uint8_t start = (_ch[i] >> 6) & 0x3F;
+		uint8_t words = (end - start * 4 + 3) / 4;
+		uint8_t t = 0;
+		while (t < LTC298X_MAX_TABLES && _tables[t].refs && (_tables[t].start != start || _tables[t].words != words)) t++;
+		if (!_tables[t].refs) {
+			_tables[t].start = start;
+			_tables[t].words = words;
+			_tables[t].hashed = false; //hashed from the RAM when needed
+		}
+		this->bindTable(i + 1, t);
+	}
+}
+/*
+ * Move all live tables to the start of the RAM and rewrite the channel words referencing them.
+ * Never called within beginConfig(), the committed words would point to moved tables until commitConfig().
+ */
+void LTC298XDevice::compactRam(void) {
+	uint8_t cursor = 0;
+	uint8_t done = 0;
+	while (true) {
+		//next live table in address order
+		uint8_t t = LTC298X_MAX_TABLES;
+		for (uint8_t i = 0; i < LTC298X_MAX_TABLES; i++) {
+			if (!_tables[i].refs || _tables[i].start < done) continue;
+			if (t == LTC298X_MAX_TABLES || _tables[i].start < _tables[t].start) t = i;
+		}
+		if (t == LTC298X_MAX_TABLES) return;
+		done = _tables[t].start + 1;
+		if (_tables[t].start > cursor) {
+			uint8_t chunk[24];
+			for (uint16_t i = 0; i < _tables[t].words * 4; i += sizeof(chunk)) {
+				uint8_t n = _tables[t].words * 4 - i < (uint16_t)sizeof(chunk) ? _tables[t].words * 4 - i : sizeof(chunk);
+				this->readRam(_tables[t].start * 4 + i, chunk, n);
+				this->writeRam(cursor * 4 + i, chunk, n); //moving down, the source is not overwritten before it is read
+			}
+			_tables[t].start = cursor;
+			for (uint8_t ch = 1; ch <= 20; ch++) {
+				if (_table_of[ch - 1] != t + 1) continue;
+				uint32_t config = (_cache_valid & ((uint32_t)1 << (ch - 1))) ? _ch[ch - 1] : this->read32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4);
+				this->storeChannel(ch, (config & ~((uint32_t)0x3F << 6)) | (uint32_t)cursor << 6);
+			}
+		}
+		cursor += _tables[t].words;
+	}
+}
+/*
+ * Mark the RAM used by the committed channel words, placeTable() does not touch it until commitConfig()
+ */
+void LTC298XDevice::pinTables(void) {
+	memset(_pinned, 0, sizeof(_pinned));
+	for (uint8_t i = 0; i < 20; i++) {
+		uint32_t bit = (uint32_t)1 << i;
+		if (!(_cache_valid & bit) || (_dirty & bit)) continue;
+		uint16_t end = this->tableEnd(_ch[i]);
+		for (uint16_t w = (_ch[i] >> 6) & 0x3F; w * 4 < end && w < LTC298X_RAM_WORDS; w++) _pinned[w >> 3] |= 1 << (w & 7);
+	}
+}
+
+/*
+ * Compare a register range with a single burst
+ */
+bool LTC298XDevice::verifyBlock(uint16_t addr, const uint8_t* buf, uint16_t len) {
+	uint8_t header[3] = {LTC298X_SPI_READ, (uint8_t)(addr >> 8), (uint8_t)addr};
+	uint8_t chunk[16];
+	bool equal = true;
+	_bus->beginTransaction();
+	_bus->transfer(header, NULL, 3);
+	for (uint16_t i = 0; i < len; i += sizeof(chunk)) {
+		uint16_t n = len - i < (uint16_t)sizeof(chunk) ? len - i : (uint16_t)sizeof(chunk);
+		_bus->transfer(NULL, chunk, n);
+		if (memcmp(chunk, buf + i, n)) equal = false;
+	}
+	_bus->endTransaction();
+	this->countTransaction(3 + len);
+	return equal;
+}
+/*
+ * End of the custom RAM area (offset in byte) used by a channel word, 0 if it uses none
+ */
+uint16_t LTC298XDevice::tableEnd(uint32_t config) {
+	uint8_t type = config >> 27;
+	uint16_t addr = ((config >> 6) & 0x3F) * 4;
+	uint16_t len = (config & 0x3F) + 1;
+	if (type == LTC298X_TYPE_THER_STEINH) return addr + 24; //6 single precision coefficients
+	if (type == LTC298X_TYPE_TC_CUST ||
+	    type == LTC298X_TYPE_RTD_CUST ||
+	    type == LTC298X_TYPE_THER_CUST
+	) return addr + len * 6;
+	return 0;
+}
+
+/*
+ * Instrumentation hooks, empty unless LTC298X_INSTRUMENTATION is set
+ */
+#if LTC298X_INSTRUMENTATION
+void LTC298XDevice::countTransaction(uint16_t bytes) {
+	_stats.transactions++;
+	_stats.bytes += bytes;
+}
+void LTC298XDevice::countStatus(uint8_t ch, uint8_t status) {
+	if (status & 0x01) _stats.valid[ch - 1]++;
+	for (uint8_t bit = 1; bit < 8; bit++) {
+		if ((status >> bit) & 1) _stats.faults[ch - 1][bit - 1]++;
+	}
+}
+//first time done is seen for the running conversion, may be called from the ISR
+void LTC298XDevice::countDone(void) {
+	if (!_conv_pending) return;
+	_conv_pending = false;
+	uint32_t latency = micros() - _conv_start;
+	if (!_stats.conversions || latency < _stats.latency_min) _stats.latency_min = latency;
+	if (latency > _stats.latency_max) _stats.latency_max = latency;
+	_stats.latency_sum += latency;
+	_stats.conversions++;
+}
+#else
+void LTC298XDevice::countTransaction(uint16_t) {}
+void LTC298XDevice::countStatus(uint8_t, uint8_t) {}
+void LTC298XDevice::countDone(void) {}
+#endif
 
 // PUBLIC
 
-LTC298X::LTC298X(uint8_t cs) : _cs(cs) {}
+/*
+ * Use a custom bus, LTC298X uses the Arduino SPI with 2 MHz.
+ * Connect INTERRUPT to irq to get notified on finished conversions without polling the command register.
+ */
+LTC298XDevice::LTC298XDevice(LTC298XTransport& bus) : _bus(&bus) {}
+LTC298XDevice::LTC298XDevice(LTC298XTransport& bus, uint8_t irq) : _bus(&bus), _irq_pin(irq) {}
+
+LTC298X::LTC298X(uint8_t cs) : LTC298XOwnSPI(cs), LTC298XDevice(_spi) {}
+LTC298X::LTC298X(uint8_t cs, uint8_t irq) : LTC298XOwnSPI(cs), LTC298XDevice(_spi, irq) {}
 
-void LTC298X::begin(void) {
-	digitalWrite(_cs, HIGH);
-	pinMode(_cs, OUTPUT);
-	SPI.begin();
+void LTC298XDevice::begin(void) {
+	_bus->begin();
+	_irq = _irq_pin;
+	if (_irq == LTC298X_NO_IRQ) return;
+	for (uint8_t i = 0; i < LTC298X_MAX_IRQ_DEVICES; i++) {
+		if (irq_devices[i] && irq_devices[i] != this) continue;
+		irq_devices[i] = this;
+		pinMode(_irq, INPUT);
+		attachInterrupt(digitalPinToInterrupt(_irq), irq_handlers[i], RISING);
+		return;
+	}
+	_irq = LTC298X_NO_IRQ; //no free handler, fall back to polling
+}
+/*
+ * Detach INTERRUPT and free its handler for other devices, the destructor does so too.
+ * Completion is polled from the command register until the next begin().
+ */
+void LTC298XDevice::end(void) {
+	for (uint8_t i = 0; i < LTC298X_MAX_IRQ_DEVICES; i++) {
+		if (irq_devices[i] != this) continue;
+		detachInterrupt(digitalPinToInterrupt(_irq));
+		irq_devices[i] = NULL; //after detaching, the handler may run until then
+	}
+	_irq = LTC298X_NO_IRQ;
+}
+LTC298XDevice::~LTC298XDevice(void) {
+	this->end();
 }
 
 /*
  * Returns done-Flag, which will reflect the interrupt state (isDone = true/INTERRUPT = HIGH).
  * For faster use, react on interrupt state instead of polling the register.
  */
-bool LTC298X::isDone(void) {
-	return read8(LTC298X_ADDR_CMD) & 0x40;
+bool LTC298XDevice::isDone(void) {
+	if (!(read8(LTC298X_ADDR_CMD) & 0x40)) return false;
+#if LTC298X_INSTRUMENTATION
+	//the ISR may count the same conversion
+#ifdef __AVR__
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		this->countDone();
+	}
+#else
+	noInterrupts();
+	this->countDone();
+	interrupts();
+#endif
+#endif
+	return true;
 }
 /*
  * Returns error/valid flags
  */
-uint8_t LTC298X::getState(void) {
+uint8_t LTC298XDevice::getState(void) {
 	return _state;
 }
 /*
  * Report values either in Fahrenheit or degree Celius.
  */
-void LTC298X::reportFahrenheit(void) {
-	uint8_t tmp = read8(LTC298X_ADDR_CONFIG_GLOB); //preserve old rejection settings
-	this->write8(LTC298X_ADDR_CONFIG_GLOB, tmp | 0x04); //set B[2]
+void LTC298XDevice::reportFahrenheit(void) {
+	this->writeGlobal(0x04, 0x04); //set B[2], preserve rejection settings
 }
-void LTC298X::reportCelsius(void) {
-	uint8_t tmp = read8(LTC298X_ADDR_CONFIG_GLOB); //preserve old rejection settings
-	this->write8(LTC298X_ADDR_CONFIG_GLOB, tmp & ~0x04); //unset B[2]
+void LTC298XDevice::reportCelsius(void) {
+	this->writeGlobal(0x04, 0x00); //unset B[2], preserve rejection settings
 }
 /*
  * Reject 60 and/or 50 Hz AC noises (75dB @ 1 ms MUX). Select single rejection for 120dB rejection.
  */
-void LTC298X::reject6050Hz(void) {
-	uint8_t tmp = read8(LTC298X_ADDR_CONFIG_GLOB) & ~0x03; //clear rejection bits and preserve reporting unit
-	this->write8(LTC298X_ADDR_CONFIG_GLOB, tmp | LTC298X_REJECT_6050HZ); //set new rejection setting B[1:0]
+void LTC298XDevice::reject6050Hz(void) {
+	this->writeGlobal(0x03, LTC298X_REJECT_6050HZ); //set new rejection setting B[1:0], preserve reporting unit
 }
-void LTC298X::reject60Hz(void) {
-	uint8_t tmp = read8(LTC298X_ADDR_CONFIG_GLOB) & ~0x03; //clear rejection bits and preserve reporting unit
-	this->write8(LTC298X_ADDR_CONFIG_GLOB, tmp | LTC298X_REJECT_60HZ); //set new rejection setting B[1:0]
+void LTC298XDevice::reject60Hz(void) {
+	this->writeGlobal(0x03, LTC298X_REJECT_60HZ); //set new rejection setting B[1:0], preserve reporting unit
 }
-void LTC298X::reject50Hz(void) {
-	uint8_t tmp = read8(LTC298X_ADDR_CONFIG_GLOB) & ~0x03; //clear rejection bits and preserve reporting unit
-	this->write8(LTC298X_ADDR_CONFIG_GLOB, tmp | LTC298X_REJECT_50HZ); //set new rejection setting B[1:0]
+void LTC298XDevice::reject50Hz(void) {
+	this->writeGlobal(0x03, LTC298X_REJECT_50HZ); //set new rejection setting B[1:0], preserve reporting unit
 }
 /*
  * Set MUX switching delay to us * 10 µs, default is us = 100 or 1ms.
  */
-void LTC298X::setMuxDelay(uint8_t us) {
+void LTC298XDevice::setMuxDelay(uint8_t us) {
+	if ((_cache_valid & LTC298X_CACHE_MUX) && _mux == us) return; //unchanged
 	this->write8(LTC298X_ADDR_MUX_DELAY, us);
+	_mux = us;
+	_cache_valid |= LTC298X_CACHE_MUX;
 }
 /*
  * Select the Channels for conversion.
  * Set channels to (1 << 5) | (1 << 1) to select channel 6 and 2
  */
-bool LTC298X::selectConversionChannels(uint32_t channels) {
+bool LTC298XDevice::selectConversionChannels(uint32_t channels) {
 	if (channels >= 0x100000) return false; //invalid
+	if ((_cache_valid & LTC298X_CACHE_MASK) && _mask == channels) return true; //unchanged
 	this->write32(LTC298X_ADDR_MULTIREAD, channels);
+	_mask = channels;
+	_cache_valid |= LTC298X_CACHE_MASK;
 	return true;
 }
 /*
  * Start sampling of ADCs. INTERRUPT will go LOW while conversion. If done, it toggles HIGH.
  */
-void LTC298X::beginConversion(uint8_t ch) {
+void LTC298XDevice::beginConversion(uint8_t ch) {
 	if (ch > 20 || ch == 0) return;
+	_conv_channels = (uint32_t)1 << (ch - 1);
+	_conv_estimated = false; //estimated on demand, a cold cache would delay the start
+	_done = false;
 	this->write8(LTC298X_ADDR_CMD, LTC298X_CMD_BEGIN | ch);
+	_conv_start = micros();
+#if LTC298X_INSTRUMENTATION
+	_conv_pending = true;
+#endif
 }
-void LTC298X::beginMultipleConversion(void) {
+void LTC298XDevice::beginMultipleConversion(void) {
+	_conv_channels = 0; //the selected channels
+	_conv_estimated = false;
+	_done = false;
 	this->write8(LTC298X_ADDR_CMD, LTC298X_CMD_BEGIN); //B[4:0] = 0
+	_conv_start = micros();
+#if LTC298X_INSTRUMENTATION
+	_conv_pending = true;
+#endif
+}
+
+/*
+ * Conversion time model, using the shadowed channel assignments and global settings (read once if not known).
+ * Each converted sensor takes two cycles, one more for diodes with three readings, thermocouple open circuit detection,
+ * current source rotation and thermistor auto ranging. A thermocouple also converts its cold junction sensor.
+ * The MUX delay is added before every cycle.
+ */
+uint32_t LTC298XDevice::selectedChannels(void) {
+	if (!(_cache_valid & LTC298X_CACHE_MASK)) {
+		_mask = this->read32(LTC298X_ADDR_MULTIREAD) & 0xFFFFF;
+		_cache_valid |= LTC298X_CACHE_MASK;
+	}
+	return _mask;
+}
+uint32_t LTC298XDevice::channelConfig(uint8_t ch) {
+	uint32_t bit = (uint32_t)1 << (ch - 1);
+	if (!(_cache_valid & bit)) {
+		_ch[ch - 1] = this->read32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4);
+		_cache_valid |= bit;
+	}
+	return _ch[ch - 1];
+}
+uint8_t LTC298XDevice::conversionCycles(uint8_t ch) {
+	uint32_t config = this->channelConfig(ch);
+	uint8_t type = config >> 27;
+	if (type >= LTC298X_TYPE_TC_J && type <= LTC298X_TYPE_TC_CUST) {
+		uint8_t cj_ch = (config >> 22) & 0x1F;
+		uint8_t cycles = 2 + ((config >> 20) & 1); //open circuit detection
+		//the cold junction sensor is converted too, it can not be a thermocouple itself
+		if (cj_ch && cj_ch <= 20 && (this->channelConfig(cj_ch) >> 27) > LTC298X_TYPE_TC_CUST) cycles += this->conversionCycles(cj_ch);
+		return cycles;
+	}
+	if (type >= LTC298X_TYPE_PT_10 && type <= LTC298X_TYPE_RTD_CUST) {
+		return 2 + (((config >> 18) & 0x03) == LTC298X_MODE_CS_SR);
+	}
+	if (type >= LTC298X_TYPE_THER_44004 && type <= LTC298X_TYPE_THER_CUST) {
+		return 2 + (((config >> 19) & 0x03) == LTC298X_MODE_CS_SR) + (((config >> 15) & 0x0F) == TR_CURRENT_AUTO);
+	}
+	if (type == LTC298X_TYPE_DIODE) return 2 + ((config >> 25) & 1); //three readings
+	if (type == LTC298X_TYPE_ADC) return 2;
+	return 0; //unassigned or sense resistor, not converted on its own
+}
+/*
+ * Predicted time in µs to convert channels (bit mask as for selectConversionChannels, 0 for the selected channels)
+ * with the current settings or with a rejection mode (LTC298X_REJECT_*) and MUX delay (as for setMuxDelay).
+ */
+uint32_t LTC298XDevice::estimateConversionTime(uint32_t channels) {
+	if (!(_cache_valid & LTC298X_CACHE_GLOB)) {
+		_glob = this->read8(LTC298X_ADDR_CONFIG_GLOB);
+		_cache_valid |= LTC298X_CACHE_GLOB;
+	}
+	if (!(_cache_valid & LTC298X_CACHE_MUX)) {
+		_mux = this->read8(LTC298X_ADDR_MUX_DELAY);
+		_cache_valid |= LTC298X_CACHE_MUX;
+	}
+	return this->estimateConversionTime(channels, _glob & 0x03, _mux);
+}
+uint32_t LTC298XDevice::estimateConversionTime(uint32_t channels, uint8_t reject, uint8_t mux_delay) {
+	if (!channels) channels = this->selectedChannels();
+	uint32_t cycle = LTC298X_CYCLE_US_6050HZ;
+	if (reject == LTC298X_REJECT_60HZ) cycle = LTC298X_CYCLE_US_60HZ;
+	else if (reject == LTC298X_REJECT_50HZ) cycle = LTC298X_CYCLE_US_50HZ;
+	cycle += (uint32_t)mux_delay * 10;
+	uint16_t cycles = 0;
+	for (uint8_t ch = 1; ch <= 20; ch++) {
+		if (channels & ((uint32_t)1 << (ch - 1))) cycles += this->conversionCycles(ch);
+	}
+	return cycles * cycle;
+}
+/*
+ * Predicted µs until the running conversion is done, 0 if it should be done already.
+ * Use it to sleep or yield (e.g. vTaskDelay) before checking for completion.
+ * The first call after the start estimates the duration, reading registers that are not shadowed yet.
+ */
+uint32_t LTC298XDevice::timeUntilDone(void) {
+	if (!_conv_estimated) {
+		_conv_us = this->estimateConversionTime(_conv_channels);
+		_conv_estimated = true;
+	}
+	uint32_t elapsed = micros() - _conv_start;
+	return elapsed >= _conv_us ? 0 : _conv_us - elapsed;
+}
+/*
+ * Sleep until shortly before the predicted end of the running conversion, then check for completion every ms.
+ * Completion is taken from INTERRUPT if an interrupt pin is set, otherwise from the command register.
+ * Returns false if the conversion is not done within timeout_ms, counted from the call.
+ */
+bool LTC298XDevice::waitUntilDone(uint32_t timeout_ms) {
+	uint32_t start = millis();
+	uint32_t remaining = this->timeUntilDone();
+	if (remaining > LTC298X_WAIT_MARGIN_US) {
+		uint32_t ms = (remaining - LTC298X_WAIT_MARGIN_US) / 1000;
+		delay(ms < timeout_ms ? ms : timeout_ms);
+	}
+	while (true) {
+		if (_irq == LTC298X_NO_IRQ ? this->isDone() : _done) {
+			_done = true; //poll() does not read the command register again
+			return true;
+		}
+		if (millis() - start >= timeout_ms) return false;
+		delay(1);
+	}
+}
+
+/*
+ * Non-blocking conversion of the selected channels.
+ * startScan() begins the conversion, poll() returns true once it is done and fetches all results with a single burst.
+ * If an interrupt pin is set, completion is taken from INTERRUPT instead of reading the command register.
+ */
+bool LTC298XDevice::startScan(void) {
+	_scan_mask = this->selectedChannels();
+	if (!_scan_mask) return false; //nothing selected
+	_done = false;
+	_scanning = true;
+	this->beginMultipleConversion();
+	return true;
+}
+bool LTC298XDevice::startScan(uint32_t channels) {
+	if (!channels || !this->selectConversionChannels(channels)) return false;
+	return this->startScan();
+}
+bool LTC298XDevice::poll(int32_t* raw, uint8_t* status) {
+	if (!_scanning) return false;
+	if (!_done && (_irq != LTC298X_NO_IRQ || !this->isDone())) return false;
+	_scanning = false;
+	if (!this->readResults(_scan_mask, raw, status)) return false;
+	if (_filters) {
+		for (uint8_t i = 0; i < 20; i++) {
+			if ((_scan_mask & ((uint32_t)1 << i)) && (status[i] & 0x01)) raw[i] = _filters->update(i + 1, raw[i]);
+		}
+	}
+	uint32_t now = millis();
+	_report_mask = _reporter ? _reporter->update(_scan_mask, raw, status, now) : _scan_mask;
+	if (_ring) {
+		LTC298XSample sample;
+		sample.time = now;
+		for (uint8_t i = 0; i < 20; i++) {
+			if (!(_report_mask & ((uint32_t)1 << i))) continue;
+			sample.ch = i + 1;
+			sample.raw = raw[i];
+			sample.status = status[i];
+			_ring->push(sample);
+		}
+	}
+	return true;
+}
+/*
+ * Poll and hand the results to the callback set by onScanComplete(). Call this from loop(), not from an ISR.
+ */
+bool LTC298XDevice::poll(void) {
+	int32_t raw[20];
+	uint8_t status[20];
+	if (!this->poll(raw, status)) return false;
+	if (_callback && _report_mask) _callback(_report_mask, raw, status);
+	return true;
+}
+void LTC298XDevice::onScanComplete(LTC298XCallback callback) {
+	_callback = callback;
+}
+/*
+ * Queue every result read by poll() as LTC298XSample, NULL to stop.
+ * poll() is the only producer, so it may run from a timer while loop() drains the ring.
+ */
+void LTC298XDevice::setSampleRing(LTC298XRing* ring) {
+	_ring = ring;
+}
+/*
+ * Filter every valid result read by poll() with the filter of its channel, NULL to stop.
+ * Results of readRaw() and readResults() stay unfiltered.
+ */
+void LTC298XDevice::setFilterBank(LTC298XFilterBank* filters) {
+	_filters = filters;
+}
+/*
+ * Only pass results to the sample ring and the onScanComplete() callback if reporter reports them, NULL for all.
+ * poll(raw, status) still returns every result, e.g. for LTC298XScheduler and LTC298XGroup callbacks,
+ * which can call reporter.update() themselves.
+ */
+void LTC298XDevice::setReporter(LTC298XReporter* reporter) {
+	_reporter = reporter;
+}
+/*
+ * Called on the rising edge of INTERRUPT, may also be called by other sources of the done signal.
+ */
+void LTC298XDevice::handleInterrupt(void) {
+	_done = true;
+	this->countDone();
 }
 /*
  * Pause sampling
  */
-void LTC298X::sleep(void) {
+void LTC298XDevice::sleep(void) {
 	this->write8(LTC298X_ADDR_CMD, LTC298X_CMD_SLEEP);
 }
+/*
+ * The global configuration, MUX delay, selected channels and channel assignments are shadowed locally.
+ * Call invalidateCache() after the chip has been reset or written by other means,
+ * or resync() to reload all shadowed registers from the chip at once.
+ */
+void LTC298XDevice::invalidateCache(void) {
+	_cache_valid = _dirty; //staged words are not on the chip yet
+#if LTC298X_RAM_SHADOW
+	memset(_ram_valid, 0, sizeof(_ram_valid));
+#endif
+}
+void LTC298XDevice::resync(void) {
+	_glob = this->read8(LTC298X_ADDR_CONFIG_GLOB);
+	_mux = this->read8(LTC298X_ADDR_MUX_DELAY);
+	_mask = this->read32(LTC298X_ADDR_MULTIREAD);
+	uint8_t buf[80];
+	this->readBlock(LTC298X_ADDR_CONFIG_CH1, buf, 80);
+	for (uint8_t i = 0; i < 20; i++) {
+		_ch[i] = (uint32_t)buf[i * 4] << 24 | (uint32_t)buf[i * 4 + 1] << 16 | (uint32_t)buf[i * 4 + 2] << 8 | buf[i * 4 + 3];
+	}
+	_cache_valid = LTC298X_CACHE_ALL;
+	_dirty = 0; //staged words are overwritten by the chip state
+#if LTC298X_RAM_SHADOW
+	this->readBlock(LTC298X_ADDR_RAM_START, _ram, LTC298X_RAM_SIZE);
+	memset(_ram_valid, 0xFF, sizeof(_ram_valid));
+#endif
+	this->rebuildTables();
+	if (_staging) this->pinTables();
+}
+
+/*
+ * Stage channel assignments instead of writing them immediately.
+ * All setup functions called between beginConfig() and commitConfig() only update the local image,
+ * commitConfig() then writes the changed words with as few bursts as possible.
+ * Custom tables are still uploaded immediately, but only to RAM that no committed channel word uses:
+ * a running scan keeps reading the old tables until commitConfig(). Fragmented RAM is not compacted meanwhile,
+ * so a table may not fit while staging that would fit otherwise.
+ */
+void LTC298XDevice::beginConfig(void) {
+	if (_staging) return;
+	this->pinTables();
+	_staging = true;
+}
+void LTC298XDevice::commitConfig(void) {
+	_staging = false;
+	uint8_t i = 0;
+	while (_dirty) {
+		if (!(_dirty & ((uint32_t)1 << i))) {
+			i++;
+			continue;
+		}
+		//extend the burst over dirty words and single unchanged words between them,
+		//resending a known word is cheaper than a new instruction/address header
+		uint8_t last = i;
+		for (uint8_t j = i + 1; j < 20 && j <= last + LTC298X_COMMIT_MAX_GAP + 1; j++) {
+			if (!(_cache_valid & ((uint32_t)1 << j))) break;
+			if (_dirty & ((uint32_t)1 << j)) last = j;
+		}
+		uint8_t buf[80];
+		for (uint8_t j = i; j <= last; j++) {
+			uint8_t* word = buf + (j - i) * 4;
+			word[0] = _ch[j] >> 24;
+			word[1] = _ch[j] >> 16;
+			word[2] = _ch[j] >> 8;
+			word[3] = _ch[j];
+			_dirty &= ~((uint32_t)1 << j);
+		}
+		this->writeBlock(LTC298X_ADDR_CONFIG_CH1 + i * 4, buf, (last - i + 1) * 4);
+		i = last + 1;
+	}
+}
+
+/*
+ * Upload a channel image built with LTC298XConfigImage (see LTC298XConfig.h).
+ * words points to 20 channel words in PROGMEM, they are written with a single burst or staged within beginConfig().
+ */
+void LTC298XDevice::loadConfig(const uint32_t* words) {
+	uint8_t buf[80];
+	for (uint8_t i = 0; i < 20; i++) {
+		_ch[i] = pgm_read_dword(words + i);
+		buf[i * 4]     = _ch[i] >> 24;
+		buf[i * 4 + 1] = _ch[i] >> 16;
+		buf[i * 4 + 2] = _ch[i] >> 8;
+		buf[i * 4 + 3] = _ch[i];
+	}
+	_cache_valid |= 0xFFFFF;
+	this->rebuildTables();
+	if (_staging) {
+		_dirty = 0xFFFFF;
+		return;
+	}
+	_dirty = 0;
+	this->writeBlock(LTC298X_ADDR_CONFIG_CH1, buf, 80);
+}
+/*
+ * Upload a custom table built with the LTC298X_ROW_* macros from PROGMEM.
+ * Params:
+ * start_addr_offset | Start address in RAM in 4 byte words (0-63), same as for the setupCustom functions
+ * table             | Table in PROGMEM
+ * len               | Length of the table in byte
+ */
+bool LTC298XDevice::loadTable(uint16_t start_addr_offset, const uint8_t* table, uint16_t len) {
+	if (start_addr_offset > LTC298X_MAX_ADDR_OFFSET ||
+	    start_addr_offset * 4 + len > LTC298X_RAM_SIZE
+	) return false; //invalid
+	start_addr_offset *= 4;
+#if LTC298X_RAM_SHADOW
+	uint16_t run = 0xFFFF;
+	uint16_t run_end = 0;
+	for (uint16_t i = 0; i < len; i++) this->deltaByte(start_addr_offset + i, pgm_read_byte(table + i), &run, &run_end);
+	if (run != 0xFFFF) this->writeBlock(LTC298X_ADDR_RAM_START + run, _ram + run, run_end - run + 1);
+#else
+	uint16_t addr = LTC298X_ADDR_RAM_START + start_addr_offset;
+	uint8_t header[3] = {LTC298X_SPI_WRITE, (uint8_t)(addr >> 8), (uint8_t)addr};
+	_bus->beginTransaction();
+	_bus->transfer(header, NULL, 3);
+	for (uint16_t i = 0; i < len; i++) {
+		uint8_t data = pgm_read_byte(table + i);
+		_bus->transfer(&data, NULL, 1);
+	}
+	_bus->endTransaction();
+	this->countTransaction(3 + len);
+#endif
+	return true;
+}
 
 /*
  * Detach sensor from channel
  */
-bool LTC298X::disableChannel(uint8_t ch) {
+bool LTC298XDevice::disableChannel(uint8_t ch) {
 	if (ch < 1 ||
 	    ch > 20
 	) return false;
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + ch * 4, 0);
+	this->writeChannel(ch, 0);
 	return true;
 }
 
-bool LTC298X::setupADC(uint8_t ch, bool single_end) {
+bool LTC298XDevice::setupADC(uint8_t ch, bool single_end) {
 	if (ch < 2 - single_end ||
 	    ch > 20
 	) return false;
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, (uint32_t)LTC298X_TYPE_ADC << 27);
+	this->writeChannel(ch, LTC298XWord::adc(single_end));
 	return true;
 }
 
 /*
  * Alias
  */
-bool LTC298X::setupDiode(uint8_t ch, bool single_end, bool measure_three, bool average, uint8_t current) {
+bool LTC298XDevice::setupDiode(uint8_t ch, bool single_end, bool measure_three, bool average, uint8_t current) {
 	return this->setupDiode(ch, single_end, measure_three, average, current, 0);
 }
 /*
@@ -179,29 +942,15 @@ bool LTC298X::setupDiode(uint8_t ch, bool single_end, bool measure_three, bool a
  * average       | Calculate the average by last/2 + this/2 if difference is < 2°C
  * ideality      | Ideality factor, defaults to 1.03 if 0 is written.
  */
-bool LTC298X::setupDiode(uint8_t ch, bool single_end, bool measure_three, bool average, uint8_t current, double ideality) {
+bool LTC298XDevice::setupDiode(uint8_t ch, bool single_end, bool measure_three, bool average, uint8_t current, double ideality) {
 	if (ch < 2 - single_end ||
 	    ch > 20 ||
 	    ideality < 0 ||
 	    ideality >= 4 ||
 	    current > DIODE_CURRENT_80uA
 	) return false;
-	//remove unnecessary casts
-	uint32_t transmit = LTC298X_TYPE_DIODE;    //B[31:27]
-	transmit <<= 1; transmit |= single_end;    //B[26:26]
-	transmit <<= 1; transmit |= measure_three; //B[25:25]
-	transmit <<= 1; transmit |= average;       //B[24:24]
-	transmit <<= 2; transmit |= current;       //B[23:22]
-	transmit <<= 22;transmit |= (uint32_t)(ideality * 1048576); //convert double to 2,20 fixed point fraction
-	/*
-	uint32_t transmit = ideality * 1048576; //convert double to 2,20 fixed point fraction
-	transmit |= (uint32_t)current << 22;
-	transmit |= (uint32_t)average << 24;
-	transmit |= (uint32_t)measure_three << 25;
-	transmit |= (uint32_t)single_end << 26;
-	transmit |= (uint32_t)LTC298X_TYPE_DIODE << 27;
-	*/
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	//convert double to 2,20 fixed point fraction
+	this->writeChannel(ch, LTC298XWord::diode(single_end, measure_three, average, current, (uint32_t)(ideality * 1048576)));
 	return true;
 }
 /*
@@ -210,28 +959,27 @@ bool LTC298X::setupDiode(uint8_t ch, bool single_end, bool measure_three, bool a
  * ch            | Channel (2-20) to use.
  * resistance    | Resistance from 0 Ohm up to 131.072 MOhm
  */
-bool LTC298X::setupSenseResistor(uint8_t ch, double resistance) {
+bool LTC298XDevice::setupSenseResistor(uint8_t ch, double resistance) {
 	if (ch < 2 ||
 	    ch > 20 ||
 	    resistance < 0 ||
 	    resistance >= 131072
 	) return false;
-	uint32_t transmit = LTC298X_TYPE_SENSERES; //B[31:27]
-	transmit <<= 27; transmit |= (uint32_t)(resistance * 1024); //convert double to 17,10 fixed point fraction
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	//convert double to 17,10 fixed point fraction
+	this->writeChannel(ch, LTC298XWord::senseResistor((uint32_t)(resistance * 1024)));
 	return true;
 }
 
 /*
  * Alias
  */
-bool LTC298X::setupThermocouple(uint8_t ch, uint8_t type, bool single_end) {
+bool LTC298XDevice::setupThermocouple(uint8_t ch, uint8_t type, bool single_end) {
 	return this->setupThermocouple(ch, type, 0, single_end, false, TC_NO_COLDJUNCTION);
 }
 /*
  * Alias
  */
-bool LTC298X::setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool single_end) {
+bool LTC298XDevice::setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool single_end) {
 	return this->setupThermocouple(ch, type, cj_ch, single_end, false, TC_NO_COLDJUNCTION);
 }
 /*
@@ -244,22 +992,14 @@ bool LTC298X::setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool si
  * oc_detect  | Detect open circuit (broken/unattached sensor)
  * oc_current | Current used for open circuit detection. Any from TC_CURRENT_10uA to TC_CURRENT_1mA
  */
-bool LTC298X::setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current) {
+bool LTC298XDevice::setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current) {
 	if (ch < 2 - single_end ||
 	    ch > 20 ||
 	    cj_ch > 20 ||
 	    type < LTC298X_TYPE_TC_J ||
 	    type > LTC298X_TYPE_TC_B
 	) return false; //invalid
-	uint32_t transmit = type;               //B[31:27]
-	transmit <<= 5; transmit |= cj_ch;      //B[26:22]
-	transmit <<= 1; transmit |= single_end; //B[21:21]
-	transmit <<= 1; transmit |= oc_detect;  //B[20:20]
-	transmit <<= 2; transmit |= oc_current; //B[19:18]
-	//B[17:12] unused
-	//B[11:00] unused for predefined thermocouple
-	transmit <<= 18;
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	this->writeChannel(ch, LTC298XWord::thermocouple(type, cj_ch, single_end, oc_detect, oc_current, 0, 0));
 	return true;
 }
 /*
@@ -273,15 +1013,18 @@ bool LTC298X::setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool si
  * mV                | Pointer to doubles of monotonically increasing voltages of the thermocouple
  * mV                | Pointer to doubles of monotonically increasing temperature of the thermocouple corresponding to the mV at same index
  * num_values        | Number of values in array
- * start_addr_offset | Start address in RAM indexed at 0
+ * start_addr_offset | Start address in RAM in 4 byte words (0-63), omit to let the allocator place it
  */
-bool LTC298X::setupCustomThermocouple(uint8_t ch, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current, double* mV, double* kelvin, uint8_t num_values, uint16_t start_addr_offset) {
+bool LTC298XDevice::setupCustomThermocouple(uint8_t ch, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current, double* mV, double* kelvin, uint8_t num_values) {
+	return this->setupCustomThermocouple(ch, cj_ch, single_end, oc_detect, oc_current, mV, kelvin, num_values, LTC298X_AUTO_ADDR);
+}
+bool LTC298XDevice::setupCustomThermocouple(uint8_t ch, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current, double* mV, double* kelvin, uint8_t num_values, uint16_t start_addr_offset) {
 	if (ch < 2 - single_end ||
 	    ch > 20 ||
 	    cj_ch > 20 ||
 	    num_values < 3 ||
-	    //ROM for custom data is only 384 byte wide, so we can store a max of 64 2x3 byte pairs
-	    start_addr_offset + num_values > 63
+	    //RAM for custom data is only 384 byte wide, so we can store a max of 64 2x3 byte pairs
+	    num_values > 64
 	) return false; //invalid
 	double old_mV = -1000;
 	double old_kelvin = 0;
@@ -290,21 +1033,15 @@ bool LTC298X::setupCustomThermocouple(uint8_t ch, uint8_t cj_ch, bool single_end
 		if (mV[i] >= 256) return false; //must be less
 		if (kelvin[i] <= old_kelvin) return false; //must be greater
 		if (kelvin[i] >= 8192) return false; //must be less
-		int32_t current_mV = (int32_t)(mV[i] * 16384); //mV is saved as 9,14 signed fixed point fraction
-		write24(LTC298X_ADDR_RAM_START + start_addr_offset + i * 6, current_mV);
-		//Kelvin is absolute, so unsinged, saved as 14,10 fixed point fraction
-		write24(LTC298X_ADDR_RAM_START + start_addr_offset + i * 6 + 3, (uint32_t)(kelvin[i] * 1024));
 		old_mV = mV[i];
 		old_kelvin = kelvin[i];
 	}
-	uint32_t transmit = LTC298X_TYPE_TC_CUST;     //B[31:27]
-	transmit <<= 5; transmit |= cj_ch;            //B[26:22]
-	transmit <<= 1; transmit |= single_end;       //B[21:21]
-	transmit <<= 1; transmit |= oc_detect;        //B[20:20]
-	transmit <<= 2; transmit |= oc_current;       //B[19:18]
-	transmit <<= 12;transmit |= start_addr_offset;//B[11:06]
-	transmit <<= 6; transmit |= num_values - 1;   //B[05:00]
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	//mV is saved as 9,14 signed fixed point fraction
+	TableData data = {NULL, mV, 16384, kelvin, num_values};
+	uint8_t t = this->placeTable(ch, data, start_addr_offset);
+	if (t == LTC298X_MAX_TABLES) return false; //does not fit
+	this->writeChannel(ch, LTC298XWord::thermocouple(LTC298X_TYPE_TC_CUST, cj_ch, single_end, oc_detect, oc_current, _tables[t].start, num_values - 1));
+	this->bindTable(ch, t);
 	return true;
 }
 
@@ -320,7 +1057,7 @@ bool LTC298X::setupCustomThermocouple(uint8_t ch, uint8_t cj_ch, bool single_end
  * current     | Current used for open circuit detection. Any from RTD_CURRENT_5uA to RTD_CURRENT_1mA
  * curve       | Can be any of RTD_CURVE_EUROPEAN, RTD_CURVE_AMERICAN, RTD_CURVE_JAPANESE, RTD_CURVE_ITS_90
  */
-bool LTC298X::setupRTD(uint8_t ch, uint8_t type, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, uint8_t curve) {
+bool LTC298XDevice::setupRTD(uint8_t ch, uint8_t type, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, uint8_t curve) {
 	if (ch < (2 + (wires > 2)) ||
 	    (ch + (wires >= 4)) > 20 ||
 	    sr_ch < 2 ||
@@ -332,18 +1069,13 @@ bool LTC298X::setupRTD(uint8_t ch, uint8_t type, uint8_t sr_ch, uint8_t wires, u
 	    type < LTC298X_TYPE_PT_10 ||
 	    type > LTC298X_TYPE_NI_120
 	) return false; //invalid
-	//remove unnecessary casts
-	uint32_t transmit = type;                //B[31:27]
-	transmit <<= 5; transmit |= sr_ch;       //B[26:22]
-	transmit <<= 2; transmit |= wires - 2;   //B[21:20]
-	transmit <<= 2; transmit |= mode;        //B[19:18]
-	transmit <<= 4; transmit |= current;     //B[17:14]
-	transmit <<= 2; transmit |= curve;       //B[13:12]
-	transmit <<= 12;                         //B[11:00] unused for predefined RTD
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	this->writeChannel(ch, LTC298XWord::rtd(type, sr_ch, wires, mode, current, curve, 0, 0));
 	return true;
 }
-bool LTC298X::setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values, uint16_t start_addr_offset) {
+bool LTC298XDevice::setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values) {
+	return this->setupCustomRTD(ch, sr_ch, wires, mode, current, ohm, kelvin, num_values, LTC298X_AUTO_ADDR);
+}
+bool LTC298XDevice::setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values, uint16_t start_addr_offset) {
 	if (ch < (2 + (wires > 2)) ||
 	    (ch + (wires == 4)) > 20 ||
 	    sr_ch < 2 ||
@@ -353,8 +1085,8 @@ bool LTC298X::setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t m
 	    (wires == 2 && mode == LTC298X_MODE_CS_SR) ||
 	    mode > LTC298X_MODE_CS_SR ||
 	    num_values < 3 ||
-	    //ROM for custom data is only 384 byte wide, so we can store a max of 64 2x3 byte pairs
-	    start_addr_offset + num_values > 63
+	    //RAM for custom data is only 384 byte wide, so we can store a max of 64 2x3 byte pairs
+	    num_values > 64
 	) return false; //invalid
 	double old_ohm = 0;
 	double old_kelvin = 0;
@@ -363,21 +1095,15 @@ bool LTC298X::setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t m
 		if (ohm[i] >= 4096) return false; //must be less
 		if (kelvin[i] <= old_kelvin) return false; //must be greater
 		if (kelvin[i] >= 8192) return false; //must be less
-		//Resistance is absolute, so unsigned, saved as 13,11 unsigned fixed point fraction
-		write24(LTC298X_ADDR_RAM_START + start_addr_offset + i * 6, (uint32_t)(ohm[i] * 2048));
-		//Kelvin is absolute, so unsinged, saved as 14,10 fixed point fraction
-		write24(LTC298X_ADDR_RAM_START + start_addr_offset + i * 6 + 3, (uint32_t)(kelvin[i] * 1024));
 		old_ohm = ohm[i];
 		old_kelvin = kelvin[i];
 	}
-	uint32_t transmit = LTC298X_TYPE_RTD_CUST;    //B[31:27]
-	transmit <<= 5; transmit |= sr_ch;            //B[26:22]
-	transmit <<= 2; transmit |= wires-2;          //B[21:20]
-	transmit <<= 2; transmit |= mode;             //B[19:18]
-	transmit <<= 4; transmit |= current;          //B[17:14]
-	transmit <<= 8; transmit |= start_addr_offset;//B[11:06]
-	transmit <<= 6; transmit |= num_values - 1;   //B[05:00]
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	//Resistance is absolute, so unsigned, saved as 13,11 unsigned fixed point fraction
+	TableData data = {NULL, ohm, 2048, kelvin, num_values};
+	uint8_t t = this->placeTable(ch, data, start_addr_offset);
+	if (t == LTC298X_MAX_TABLES) return false; //does not fit
+	this->writeChannel(ch, LTC298XWord::rtd(LTC298X_TYPE_RTD_CUST, sr_ch, wires, mode, current, 0, _tables[t].start, num_values - 1));
+	this->bindTable(ch, t);
 	return true;
 }
 
@@ -393,7 +1119,7 @@ bool LTC298X::setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t m
  * sr_sharing  | Sense resistor sharing
  * current     | Current can be any from LTC298X_TYPE_THER_44004 to TR_CURRENT_AUTO
  */
-bool LTC298X::setupThermistor(uint8_t ch, uint8_t type, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current) {
+bool LTC298XDevice::setupThermistor(uint8_t ch, uint8_t type, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current) {
 	if (ch < (2 - single_end) ||
 	    ch > 20 ||
 	    sr_ch < 2 ||
@@ -404,16 +1130,7 @@ bool LTC298X::setupThermistor(uint8_t ch, uint8_t type, uint8_t sr_ch, bool sing
 	    type < LTC298X_TYPE_THER_44004 ||
 	    type > LTC298X_TYPE_THER_SPECT
 	) return false; //invalid
-	//remove unnecessary casts
-	uint32_t transmit = type;                //B[31:27]
-	transmit <<= 5; transmit |= sr_ch;       //B[26:22]
-	transmit <<= 1; transmit |= single_end;  //B[21:21]
-	transmit <<= 2; transmit |= mode;        //B[20:19]
-	transmit <<= 4; transmit |= current;     //B[18:15]
-	//B[14:12] unused
-	//B[11:00] unused for predefined Thermistor
-	transmit <<= 12;
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	this->writeChannel(ch, LTC298XWord::thermistor(type, sr_ch, single_end, mode, current, 0, 0));
 	return true;
 }
 
@@ -428,29 +1145,32 @@ bool LTC298X::setupThermistor(uint8_t ch, uint8_t type, uint8_t sr_ch, bool sing
  * current     | Current can be any from LTC298X_TYPE_THER_44004 to TR_CURRENT_AUTO
  * coeff       | Array of A-F Steinhart-Hart-Coefficients
  */
-bool LTC298X::setupSteinhartHartThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, float coeff[6], uint16_t start_addr_offset) {
+bool LTC298XDevice::setupSteinhartHartThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, float coeff[6]) {
+	return this->setupSteinhartHartThermistor(ch, sr_ch, single_end, mode, current, coeff, LTC298X_AUTO_ADDR);
+}
+bool LTC298XDevice::setupSteinhartHartThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, float coeff[6], uint16_t start_addr_offset) {
 	if (ch < (2 - single_end) ||
 	    ch > 20 ||
 	    sr_ch < 2 ||
 	    sr_ch > 20 ||
 	    current < TR_CURRENT_250nA ||
 	    current > TR_CURRENT_AUTO ||
-	    mode > LTC298X_MODE_CS_SR ||
-	    start_addr_offset >= LTC298X_ADDR_RAM_WIDTH - 20
+	    mode > LTC298X_MODE_CS_SR
 	) return false; //invalid
+	uint8_t buf[24];
 	for (uint8_t i = 0; i < 6; i++) {
 		//Coefficients are stored as single precision floats
 		uint32_t coefficient = *reinterpret_cast<uint32_t*>(&coeff[i]);
-		this->write32(LTC298X_ADDR_RAM_START + start_addr_offset + i * 4, coefficient);
-	}
-	uint32_t transmit = LTC298X_TYPE_THER_STEINH; //B[31:27]
-	transmit <<= 5; transmit |= sr_ch;            //B[26:22]
-	transmit <<= 1; transmit |= single_end;       //B[21:21]
-	transmit <<= 2; transmit |= mode;             //B[20:19]
-	transmit <<= 4; transmit |= current;          //B[18:15]
-	transmit <<= 10;transmit |= start_addr_offset;//B[11:06]
-	transmit <<= 6; transmit |= 5;                //B[05:00] 
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+		buf[i * 4]     = coefficient >> 24;
+		buf[i * 4 + 1] = coefficient >> 16;
+		buf[i * 4 + 2] = coefficient >> 8;
+		buf[i * 4 + 3] = coefficient;
+	}
+	TableData data = {buf, NULL, 0, NULL, 4}; //24 byte as 4 rows
+	uint8_t t = this->placeTable(ch, data, start_addr_offset);
+	if (t == LTC298X_MAX_TABLES) return false; //does not fit
+	this->writeChannel(ch, LTC298XWord::thermistor(LTC298X_TYPE_THER_STEINH, sr_ch, single_end, mode, current, _tables[t].start, 5));
+	this->bindTable(ch, t);
 	return true;
 }
 
@@ -465,7 +1185,10 @@ bool LTC298X::setupSteinhartHartThermistor(uint8_t ch, uint8_t sr_ch, bool singl
  * current     | Current can be any from LTC298X_TYPE_THER_44004 to TR_CURRENT_AUTO
  * coeff       | Array of A-F Steinhart-Hart-Coefficients
  */
-bool LTC298X::setupCustomThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values, uint16_t start_addr_offset) {
+bool LTC298XDevice::setupCustomThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values) {
+	return this->setupCustomThermistor(ch, sr_ch, single_end, mode, current, ohm, kelvin, num_values, LTC298X_AUTO_ADDR);
+}
+bool LTC298XDevice::setupCustomThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values, uint16_t start_addr_offset) {
 	if (ch < (2 - single_end) ||
 	    ch > 20 ||
 	    sr_ch < 2 ||
@@ -474,8 +1197,8 @@ bool LTC298X::setupCustomThermistor(uint8_t ch, uint8_t sr_ch, bool single_end,
 	    current > TR_CURRENT_AUTO ||
 	    mode > LTC298X_MODE_CS_SR ||
 	    num_values < 3 ||
-	    //ROM for custom data is only 384 byte wide, so we can store a max of 64 2x3 byte pairs
-	    start_addr_offset + num_values > 63
+	    //RAM for custom data is only 384 byte wide, so we can store a max of 64 2x3 byte pairs
+	    num_values > 64
 	) return false; //invalid
 	double old_ohm = 0;
 	double old_kelvin = 0;
@@ -484,42 +1207,251 @@ bool LTC298X::setupCustomThermistor(uint8_t ch, uint8_t sr_ch, bool single_end,
 		if (ohm[i] >= 524288) return false; //must be less
 		if (kelvin[i] <= old_kelvin) return false; //must be greater
 		if (kelvin[i] >= 8192) return false; //must be less
-		//Resistance is absolute, so unsigned, saved as 20,4 unsigned fixed point fraction
-		write24(LTC298X_ADDR_RAM_START + start_addr_offset + i * 6, (uint32_t)(ohm[i] * 16));
-		//Kelvin is absolute, so unsinged, saved as 14,10 fixed point fraction
-		write24(LTC298X_ADDR_RAM_START + start_addr_offset + i * 6 + 3, (uint32_t)(kelvin[i] * 1024));
 		old_ohm = ohm[i];
 		old_kelvin = kelvin[i];
 	}
-	uint32_t transmit = LTC298X_TYPE_THER_CUST;   //B[31:27]
-	transmit <<= 5; transmit |= sr_ch;            //B[26:22]
-	transmit <<= 1; transmit |= single_end;       //B[21:21]
-	transmit <<= 2; transmit |= mode;             //B[20:19]
-	transmit <<= 4; transmit |= current;          //B[18:15]
-	transmit <<= 10;transmit |= start_addr_offset;//B[11:06]
-	transmit <<= 6; transmit |= num_values - 1;   //B[05:00]
-	this->write32(LTC298X_ADDR_CONFIG_CH1 + (ch - 1) * 4, transmit);
+	//Resistance is absolute, so unsigned, saved as 20,4 unsigned fixed point fraction
+	TableData data = {NULL, ohm, 16, kelvin, num_values};
+	uint8_t t = this->placeTable(ch, data, start_addr_offset);
+	if (t == LTC298X_MAX_TABLES) return false; //does not fit
+	this->writeChannel(ch, LTC298XWord::thermistor(LTC298X_TYPE_THER_CUST, sr_ch, single_end, mode, current, _tables[t].start, num_values - 1));
+	this->bindTable(ch, t);
 	return true;
 }
 /*
  * Read temperature from channel if available in previously set unit.
  */
-double LTC298X::readTemperature(uint8_t ch) {
-	if (ch > 20 || ch == 0) return NAN; //invalid, leave error register unchanged
-	uint32_t val = this->read32(LTC298X_ADDR_RESULT_CH1 + (ch - 1) * 4);
-	_state = val >> 24;
-	int32_t fp_temp = val & 0xFFFFFF; //extract relevant bits
-	if (fp_temp & 0x800000) fp_temp |= 0xFF000000; //convert from 24bit signed to 32bit signed
+double LTC298XDevice::readTemperature(uint8_t ch) {
+	int32_t fp_temp = this->readRaw(ch, NULL);
+	if (fp_temp == LTC298X_INVALID_RAW) return NAN; //invalid, leave error register unchanged
 	return fp_temp/1024.0; //convert from 13,10 fixed point fraction
 }
 /*
  * Read raw ADC voltage in Range of GND - 50 mV and VDD - 300 mV.
  */
-double LTC298X::readADC(uint8_t ch) {
-	if (ch > 20 || ch == 0) return NAN; //invalid, leave error register unchanged
+double LTC298XDevice::readADC(uint8_t ch) {
+	int32_t fp_temp = this->readRaw(ch, NULL);
+	if (fp_temp == LTC298X_INVALID_RAW) return NAN; //invalid, leave error register unchanged
+	return fp_temp/2097152.0; //convert from 2,21 fixed point fraction
+}
+/*
+ * Integer variants without floating point math.
+ * readRaw returns the signed result word, 13,10 fixed point for temperatures and 2,21 for ADC channels,
+ * or LTC298X_INVALID_RAW for an invalid channel. status receives the error/valid flags and may be NULL.
+ */
+int32_t LTC298XDevice::readRaw(uint8_t ch, uint8_t* status) {
+	if (ch > 20 || ch == 0) return LTC298X_INVALID_RAW; //invalid, leave error register unchanged
 	uint32_t val = this->read32(LTC298X_ADDR_RESULT_CH1 + (ch - 1) * 4);
 	_state = val >> 24;
-	int32_t fp_temp = val & 0xFFFFFF; //extract relevant bits
-	if (fp_temp & 0x800000) fp_temp |= 0xFF000000; //convert from 24bit signed to 32bit signed
-	return fp_temp/2097152.0; //convert from 2,21 fixed point fraction
-}
\ No newline at end of file
+	this->countStatus(ch, _state);
+	if (status) *status = _state;
+	return resultValue(val);
+}
+/*
+ * Temperature in 1/1000 of the reported unit
+ */
+int32_t LTC298XDevice::readTemperatureMilli(uint8_t ch, uint8_t* status) {
+	int32_t raw = this->readRaw(ch, status);
+	if (raw == LTC298X_INVALID_RAW) return raw;
+	return rawToMilli(raw);
+}
+/*
+ * ADC voltage in µV
+ */
+int32_t LTC298XDevice::readADCMicrovolts(uint8_t ch, uint8_t* status) {
+	int32_t raw = this->readRaw(ch, status);
+	if (raw == LTC298X_INVALID_RAW) return raw;
+	return rawToMicrovolts(raw);
+}
+/*
+ * Convert results of readRaw or readResults, rounded to nearest.
+ */
+int32_t LTC298XDevice::rawToMilli(int32_t raw) {
+	return (raw * 125 + 64) >> 7; //x * 1000 / 1024, fits 32 bit for 24 bit results
+}
+int32_t LTC298XDevice::rawToMicrovolts(int32_t raw) {
+	return ((int64_t)raw * 15625 + 16384) >> 15; //x * 1000000 / 2097152
+}
+/*
+ * Read the results of several channels with a single burst.
+ * Params:
+ * mask   | Channels to read, same format as selectConversionChannels. If 0, the last selected channels are read.
+ * raw    | Array of 20 signed results indexed by ch - 1, 13,10 fixed point for temperatures, 2,21 for ADC channels
+ * status | Array of 20 error/valid flags indexed by ch - 1, may be NULL
+ * Only entries of channels in mask are written, getState() is left unchanged.
+ */
+bool LTC298XDevice::readResults(uint32_t mask, int32_t* raw, uint8_t* status) {
+	if (!mask) mask = this->selectedChannels();
+	if (!mask || mask >= 0x100000) return false; //invalid
+	uint8_t first = 0;
+	uint8_t last = 19;
+	while (!(mask & ((uint32_t)1 << first))) first++;
+	while (!(mask & ((uint32_t)1 << last))) last--;
+	uint8_t buf[80];
+	//only transfer the span between the first and last selected channel
+	this->readBlock(LTC298X_ADDR_RESULT_CH1 + first * 4, buf, (last - first + 1) * 4);
+	for (uint8_t i = first; i <= last; i++) {
+		if (!(mask & ((uint32_t)1 << i))) continue;
+		const uint8_t* word = buf + (i - first) * 4;
+		if (status) status[i] = word[0];
+		this->countStatus(i + 1, word[0]);
+		raw[i] = resultValue((uint32_t)word[1] << 16 | (uint32_t)word[2] << 8 | word[3]);
+	}
+	return true;
+}
+
+/*
+ * Capture the chip configuration into buf for a later restoreImage().
+ * The image holds the global configuration, MUX delay, selected channels, all channel assignments
+ * and the part of the custom RAM referenced by them. Returns the image length or 0 if size is too small
+ * or channel assignments are staged, commit them first.
+ * Layout (version 1):
+ * [0]      LTC298X_IMAGE_MAGIC
+ * [1]      LTC298X_IMAGE_VERSION
+ * [2]      global configuration
+ * [3]      MUX delay
+ * [4:7]    selected channels
+ * [8:9]    length of custom RAM
+ * [10:89]  channel assignments as stored at 0x200
+ * [90:]    custom RAM from 0x250
+ */
+uint16_t LTC298XDevice::saveImage(uint8_t* buf, uint16_t size) {
+	if (size < LTC298X_IMAGE_HEADER + 80 || _staging || _dirty) return 0; //the chip contents would replace staged words
+	uint8_t glob[16];
+	this->readBlock(LTC298X_ADDR_CONFIG_GLOB, glob, 16); //0x0F0 to 0x0FF
+	this->readBlock(LTC298X_ADDR_CONFIG_CH1, buf + LTC298X_IMAGE_HEADER, 80);
+	uint16_t ram_len = 0;
+	for (uint8_t i = 0; i < 20; i++) {
+		const uint8_t* word = buf + LTC298X_IMAGE_HEADER + i * 4;
+		_ch[i] = (uint32_t)word[0] << 24 | (uint32_t)word[1] << 16 | (uint32_t)word[2] << 8 | word[3];
+		uint16_t end = this->tableEnd(_ch[i]);
+		if (end > ram_len) ram_len = end;
+	}
+	if (ram_len > LTC298X_RAM_SIZE) ram_len = LTC298X_RAM_SIZE;
+	if (size < LTC298X_IMAGE_HEADER + 80 + ram_len) return 0;
+	if (ram_len) this->readBlock(LTC298X_ADDR_RAM_START, buf + LTC298X_IMAGE_HEADER + 80, ram_len);
+	_glob = glob[0];
+	_mux = glob[LTC298X_ADDR_MUX_DELAY - LTC298X_ADDR_CONFIG_GLOB];
+	_mask = (uint32_t)glob[5] << 16 | (uint32_t)glob[6] << 8 | glob[7]; //0x0F5 to 0x0F7
+	_cache_valid |= LTC298X_CACHE_ALL;
+	this->rebuildTables();
+	buf[0] = LTC298X_IMAGE_MAGIC;
+	buf[1] = LTC298X_IMAGE_VERSION;
+	buf[2] = _glob;
+	buf[3] = _mux;
+	buf[4] = 0;
+	buf[5] = _mask >> 16;
+	buf[6] = _mask >> 8;
+	buf[7] = _mask;
+	buf[8] = ram_len >> 8;
+	buf[9] = ram_len;
+	return LTC298X_IMAGE_HEADER + 80 + ram_len;
+}
+/*
+ * Write an image captured by saveImage() back to the chip.
+ * Channel assignments and custom RAM are contiguous, so they are written and verified with one burst each,
+ * the global registers are read back with one more.
+ * Returns false if the image is invalid or the read-back differs.
+ */
+bool LTC298XDevice::restoreImage(const uint8_t* buf, uint16_t len) {
+	if (len < LTC298X_IMAGE_HEADER + 80 ||
+	    buf[0] != LTC298X_IMAGE_MAGIC ||
+	    buf[1] != LTC298X_IMAGE_VERSION ||
+	    buf[4] ||
+	    (buf[5] & 0xF0) //selected channels must be below 0x100000
+	) return false; //invalid
+	uint16_t ram_len = (uint16_t)buf[8] << 8 | buf[9];
+	if (ram_len > LTC298X_RAM_SIZE || len < LTC298X_IMAGE_HEADER + 80 + ram_len) return false; //truncated
+	this->write8(LTC298X_ADDR_CONFIG_GLOB, buf[2]);
+	this->write8(LTC298X_ADDR_MUX_DELAY, buf[3]);
+	this->writeBlock(LTC298X_ADDR_MULTIREAD, buf + 4, 4);
+	const uint8_t* block = buf + LTC298X_IMAGE_HEADER;
+	this->writeBlock(LTC298X_ADDR_CONFIG_CH1, block, 80 + ram_len);
+	_glob = buf[2];
+	_mux = buf[3];
+	_mask = (uint32_t)buf[5] << 16 | (uint32_t)buf[6] << 8 | buf[7];
+	for (uint8_t i = 0; i < 20; i++) {
+		_ch[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 | (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+	}
+	_cache_valid = LTC298X_CACHE_ALL;
+	_dirty = 0;
+#if LTC298X_RAM_SHADOW
+	for (uint16_t i = 0; i < ram_len; i++) {
+		_ram[i] = block[80 + i];
+		_ram_valid[i >> 3] |= 1 << (i & 7);
+	}
+#endif
+	this->rebuildTables();
+	if (_staging) this->pinTables();
+	uint8_t glob[16];
+	this->readBlock(LTC298X_ADDR_CONFIG_GLOB, glob, 16); //0x0F0 to 0x0FF
+	if (glob[0] != buf[2] ||
+	    glob[LTC298X_ADDR_MUX_DELAY - LTC298X_ADDR_CONFIG_GLOB] != buf[3] ||
+	    memcmp(glob + (LTC298X_ADDR_MULTIREAD - LTC298X_ADDR_CONFIG_GLOB), buf + 4, 4)
+	) return false;
+	return this->verifyBlock(LTC298X_ADDR_CONFIG_CH1, block, 80 + ram_len);
+}
+/*
+ * Free custom RAM in byte, it may be fragmented until the next allocation compacts it
+ */
+uint16_t LTC298XDevice::freeRam(void) {
+	uint16_t used = 0;
+	for (uint8_t t = 0; t < LTC298X_MAX_TABLES; t++) {
+		if (_tables[t].refs) used += _tables[t].words * 4;
+	}
+	return LTC298X_RAM_WORDS * 4 - used;
+}
+
+#if LTC298X_INSTRUMENTATION
+/*
+ * Copy of the counters since the last resetStats(), see LTC298XStats.
+ * conversions and latency_* are updated from the ISR, they are read with interrupts blocked.
+ */
+LTC298XStats LTC298XDevice::getStats(void) {
+	LTC298XStats stats = _stats;
+#ifdef __AVR__
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		stats.conversions = _stats.conversions;
+		stats.latency_min = _stats.latency_min;
+		stats.latency_max = _stats.latency_max;
+		stats.latency_sum = _stats.latency_sum;
+	}
+#else
+	noInterrupts();
+	stats.conversions = _stats.conversions;
+	stats.latency_min = _stats.latency_min;
+	stats.latency_max = _stats.latency_max;
+	stats.latency_sum = _stats.latency_sum;
+	interrupts();
+#endif
+	return stats;
+}
+uint32_t LTC298XDevice::getMeanLatency(void) {
+	uint32_t conversions;
+	uint64_t sum;
+#ifdef __AVR__
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		conversions = _stats.conversions;
+		sum = _stats.latency_sum;
+	}
+#else
+	noInterrupts();
+	conversions = _stats.conversions;
+	sum = _stats.latency_sum;
+	interrupts();
+#endif
+	if (!conversions) return 0;
+	return sum / conversions;
+}
+void LTC298XDevice::resetStats(void) {
+#ifdef __AVR__
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		memset(&_stats, 0, sizeof(_stats));
+	}
+#else
+	noInterrupts();
+	memset(&_stats, 0, sizeof(_stats));
+	interrupts();
+#endif
+}
+#endif
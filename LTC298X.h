@@ -1,6 +1,10 @@
 #ifndef LTC298X_H
 #define LTC298X_H
 #include <SPI.h>
+#include "LTC298XTransport.h"
+#include "LTC298XRing.h"
+#include "LTC298XFilter.h"
+#include "LTC298XReporter.h"
 
 /****************************************************
 
@@ -30,6 +34,24 @@ V1.0 Initial Release
 #define LTC298X_ADDR_RAM_START   0x250
 #define LTC298X_ADDR_RAM_END     0x3CA
 #define LTC298X_ADDR_RAM_WIDTH   (LTC298X_ADDR_RAM_END - LTC298X_ADDR_RAM_START)
+#define LTC298X_RAM_SIZE         (LTC298X_ADDR_RAM_WIDTH + 6) //RAM_END is the start of the last 6 byte entry
+
+//Keep a local copy of the custom RAM to upload only changed bytes, costs LTC298X_RAM_SIZE * 9 / 8 byte of RAM.
+//Without it, a custom table set up again with the same content is recognized by its CRC-16 and not uploaded,
+//a changed table, Steinhart-Hart coefficients included, is rewritten as a whole and loadTable() always writes.
+#ifndef LTC298X_RAM_SHADOW
+#ifdef __AVR__
+#define LTC298X_RAM_SHADOW       0
+#else
+#define LTC298X_RAM_SHADOW       1
+#endif
+#endif
+#define LTC298X_DELTA_MAX_GAP    4 //unchanged bytes resent to join two bursts
+//Custom tables start at 0x250 + 4 * start_addr_offset, a 6 bit offset
+#define LTC298X_RAM_WORDS        (LTC298X_RAM_SIZE / 4)
+#define LTC298X_MAX_ADDR_OFFSET  63
+#define LTC298X_MAX_TABLES       20 //one per channel at most
+#define LTC298X_AUTO_ADDR        0xFFFF //let the allocator place the table
 
 #define LTC298X_ADDR_CONFIG_CH1  0x200
 #define LTC298X_ADDR_CONFIG_CH2  0x204
@@ -59,7 +81,7 @@ V1.0 Initial Release
 #define LTC298X_ADDR_RESULT_CH5  0x020
 #define LTC298X_ADDR_RESULT_CH6  0x024
 #define LTC298X_ADDR_RESULT_CH7  0x028
-#define LTC298X_ADDR_RESULT_CH8  0x03C
+#define LTC298X_ADDR_RESULT_CH8  0x02C
 #define LTC298X_ADDR_RESULT_CH9  0x030
 #define LTC298X_ADDR_RESULT_CH10 0x034
 #define LTC298X_ADDR_RESULT_CH11 0x038
@@ -185,24 +207,154 @@ V1.0 Initial Release
 #define LTC298X_CH19             (1 << 18)
 #define LTC298X_CH20             (1 << 19)
 
+#define LTC298X_CACHE_GLOB       0x100000
+#define LTC298X_CACHE_MUX        0x200000
+#define LTC298X_CACHE_MASK       0x400000
+#define LTC298X_CACHE_ALL        0x7FFFFF
+
+#define LTC298X_INVALID_RAW      INT32_MIN //never returned for a 24 bit result
+
+#define LTC298X_IMAGE_MAGIC      0x98
+#define LTC298X_IMAGE_VERSION    1
+#define LTC298X_IMAGE_HEADER     10
+#define LTC298X_IMAGE_MAX        (LTC298X_IMAGE_HEADER + 80 + LTC298X_RAM_SIZE)
+
+//Typical length of one conversion cycle, most sensors take two cycles plus the MUX delay before each
+#ifndef LTC298X_CYCLE_US_6050HZ
+#define LTC298X_CYCLE_US_6050HZ  82000
+#endif
+#ifndef LTC298X_CYCLE_US_60HZ
+#define LTC298X_CYCLE_US_60HZ    67000
+#endif
+#ifndef LTC298X_CYCLE_US_50HZ
+#define LTC298X_CYCLE_US_50HZ    80000
+#endif
+#ifndef LTC298X_WAIT_MARGIN_US
+#define LTC298X_WAIT_MARGIN_US   2000 //start polling this early before the predicted end
+#endif
+
+//Count faults, samples, bus traffic and conversion latency, see getStats()
+#ifndef LTC298X_INSTRUMENTATION
+#define LTC298X_INSTRUMENTATION  0
+#endif
+
+#define LTC298X_NO_IRQ           0xFF
+#define LTC298X_MAX_IRQ_DEVICES  4
+
+#define LTC298X_COMMIT_MAX_GAP   1 //unchanged words resent to join two bursts
+
+
+#if LTC298X_INSTRUMENTATION
+struct LTC298XStats {
+	uint32_t transactions;
+	uint32_t bytes;         //including instruction and address
+	uint32_t valid[20];     //results with the valid bit set, by ch - 1
+	uint16_t faults[20][7]; //by ch - 1 and fault bit - 1, LTC298X_ERR_OUTOFRANGE to LTC298X_ERR_SEN_HARDFAIL
+	uint32_t conversions;   //conversions seen done
+	uint32_t latency_min;   //µs from conversion start until done was seen
+	uint32_t latency_max;
+	uint64_t latency_sum;
+};
+#endif
+
+//Arrays are indexed by ch - 1 and only valid for channels in mask
+typedef void (*LTC298XCallback)(uint32_t mask, const int32_t* raw, const uint8_t* status);
 
-class LTC298X {
+/*
+ * Driver on any LTC298XTransport, LTC298X below runs it on the Arduino SPI
+ */
+class LTC298XDevice {
 	private:
 		uint8_t _state = 0;
-		uint8_t _cs;
-		bool cache_active;
-		void beginTransaction(void);
-		void endTransaction(void);
+		LTC298XTransport* _bus;
+		uint8_t _irq_pin = LTC298X_NO_IRQ; //as passed to the constructor
+		uint8_t _irq = LTC298X_NO_IRQ; //attached pin
+		volatile bool _done = false;
+		bool _scanning = false;
+		uint32_t _scan_mask = 0;
+		LTC298XCallback _callback = NULL;
+		LTC298XRing* _ring = NULL;
+		LTC298XFilterBank* _filters = NULL;
+		LTC298XReporter* _reporter = NULL;
+		uint32_t _report_mask = 0; //channels of the last scan passed on to the ring and callback
+		uint32_t _conv_start = 0; //micros() at the last conversion start
+		uint32_t _conv_channels = 0; //channels of the running conversion, 0 for the selected ones
+		uint32_t _conv_us = 0; //predicted duration of the running conversion
+		bool _conv_estimated = true;
+#if LTC298X_INSTRUMENTATION
+		LTC298XStats _stats = {};
+		volatile bool _conv_pending = false;
+#endif
+		void countTransaction(uint16_t bytes);
+		void countStatus(uint8_t ch, uint8_t status);
+		void countDone(void);
+		uint32_t _mask = 0;
+		uint8_t _glob;
+		uint8_t _mux;
+		uint32_t _ch[20];
+		uint32_t _cache_valid = 0; //B[19:0] channel assignments, B[22:20] LTC298X_CACHE_*
+		uint32_t _dirty = 0; //staged channel assignments
+		bool _staging = false;
+		//Custom RAM allocation, refs == 0 marks a free entry
+		struct Table {
+			uint8_t start; //4 byte words from LTC298X_ADDR_RAM_START
+			uint8_t words;
+			uint8_t refs;
+			bool hashed;
+			uint16_t hash;
+		};
+		//Custom table source, either raw bytes or (x, kelvin) pairs encoded on the fly, both in rows of 6 byte
+		struct TableData {
+			const uint8_t* buf;
+			const double* x;
+			double x_scale;
+			const double* kelvin;
+			uint8_t rows;
+		};
+		Table _tables[LTC298X_MAX_TABLES] = {};
+		uint8_t _table_of[20] = {0}; //index + 1 of the table used by a channel, 0 for none
+		uint8_t _pinned[(LTC298X_RAM_WORDS + 7) / 8] = {0}; //RAM words of committed channel words, kept while staging
+#if LTC298X_RAM_SHADOW
+		uint8_t _ram[LTC298X_RAM_SIZE];
+		uint8_t _ram_valid[(LTC298X_RAM_SIZE + 7) / 8] = {0};
+		void deltaByte(uint16_t offset, uint8_t data, uint16_t* run, uint16_t* run_end);
+#endif
 		void write8(uint16_t addr, uint8_t data);
 		uint8_t read8(uint16_t addr);
 		void write24(uint16_t addr, uint32_t data);
 		uint32_t read24(uint16_t addr);
 		void write32(uint16_t addr, uint32_t data);
 		uint32_t read32(uint16_t addr);
+		void writeGlobal(uint8_t clear, uint8_t set);
+		void writeChannel(uint8_t ch, uint32_t config);
+		uint32_t selectedChannels(void);
+		uint32_t channelConfig(uint8_t ch);
+		uint8_t conversionCycles(uint8_t ch);
+		void storeChannel(uint8_t ch, uint32_t config);
+		void writeRam(uint16_t offset, const uint8_t* buf, uint16_t len);
+		void readRam(uint16_t offset, uint8_t* buf, uint16_t len);
+		bool verifyBlock(uint16_t addr, const uint8_t* buf, uint16_t len);
+		uint16_t tableEnd(uint32_t config);
+		void uploadTable(uint16_t offset, const TableData& data);
+		uint16_t tableHash(uint8_t t);
+		bool sameTable(uint8_t t, const TableData& data);
+		bool rangeFree(uint16_t start, uint8_t words);
+		uint8_t placeTable(uint8_t ch, const TableData& data, uint16_t start_addr_offset);
+		void bindTable(uint8_t ch, uint8_t t);
+		void releaseTable(uint8_t ch);
+		void rebuildTables(void);
+		void compactRam(void);
+		void pinTables(void);
 		
 	public:
-		LTC298X(uint8_t cs);
+		LTC298XDevice(LTC298XTransport& bus);
+		LTC298XDevice(LTC298XTransport& bus, uint8_t irq);
+		~LTC298XDevice(void);
 		void begin(void);
+		void end(void);
+		
+		void writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len);
+		void readBlock(uint16_t addr, uint8_t* buf, uint16_t len);
 		
 		bool isDone(void);
 		uint8_t getState(void);
@@ -215,7 +367,29 @@ class LTC298X {
 		bool selectConversionChannels(uint32_t channels);
 		void beginConversion(uint8_t ch);
 		void beginMultipleConversion(void);
+		uint32_t estimateConversionTime(uint32_t channels);
+		uint32_t estimateConversionTime(uint32_t channels, uint8_t reject, uint8_t mux_delay);
+		uint32_t timeUntilDone(void);
+		bool waitUntilDone(uint32_t timeout_ms);
+		bool startScan(void);
+		bool startScan(uint32_t channels);
+		bool poll(void);
+		bool poll(int32_t* raw, uint8_t* status);
+		void onScanComplete(LTC298XCallback callback);
+		void setSampleRing(LTC298XRing* ring);
+		void setFilterBank(LTC298XFilterBank* filters);
+		void setReporter(LTC298XReporter* reporter);
+		void handleInterrupt(void);
 		void sleep(void);
+		void invalidateCache(void);
+		void resync(void);
+		void beginConfig(void);
+		void commitConfig(void);
+		void loadConfig(const uint32_t* words);
+		bool loadTable(uint16_t start_addr_offset, const uint8_t* table, uint16_t len);
+		uint16_t saveImage(uint8_t* buf, uint16_t size);
+		bool restoreImage(const uint8_t* buf, uint16_t len);
+		uint16_t freeRam(void);
 		
 		bool disableChannel(uint8_t ch);
 		bool setupDiode(uint8_t ch, bool single_end, bool measure_three, bool average, uint8_t current);
@@ -224,16 +398,47 @@ class LTC298X {
 		bool setupThermocouple(uint8_t ch, uint8_t type, bool single_end);
 		bool setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool single_end);
 		bool setupThermocouple(uint8_t ch, uint8_t type, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current);
+		bool setupCustomThermocouple(uint8_t ch, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current, double* mV, double* kelvin, uint8_t num_values);
 		bool setupCustomThermocouple(uint8_t ch, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current, double* mV, double* kelvin, uint8_t num_values, uint16_t start_addr_offset);
 		bool setupRTD(uint8_t ch, uint8_t type, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, uint8_t curve);
+		bool setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values);
 		bool setupCustomRTD(uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values, uint16_t start_addr_offset);
 		bool setupThermistor(uint8_t ch, uint8_t type, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current);
+		bool setupSteinhartHartThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, float coeff[6]);
 		bool setupSteinhartHartThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, float coeff[6], uint16_t start_addr_offset);
+		bool setupCustomThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values);
 		bool setupCustomThermistor(uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, double* ohm, double* kelvin, uint8_t num_values, uint16_t start_addr_offset);
 		bool setupADC(uint8_t ch, bool single_end);
 		
 		double readTemperature(uint8_t ch);
 		double readADC(uint8_t ch);
+		int32_t readRaw(uint8_t ch, uint8_t* status);
+		int32_t readTemperatureMilli(uint8_t ch, uint8_t* status);
+		int32_t readADCMicrovolts(uint8_t ch, uint8_t* status);
+		static int32_t rawToMilli(int32_t raw);
+		static int32_t rawToMicrovolts(int32_t raw);
+		bool readResults(uint32_t mask, int32_t* raw, uint8_t* status);
+		
+#if LTC298X_INSTRUMENTATION
+		LTC298XStats getStats(void);
+		uint32_t getMeanLatency(void);
+		void resetStats(void);
+#endif
+};
+
+/*
+ * Holds the transport of LTC298X, a base class so it is constructed before LTC298XDevice uses it
+ */
+class LTC298XOwnSPI {
+	protected:
+		LTC298XSPITransport _spi;
+		LTC298XOwnSPI(uint8_t cs) : _spi(cs) {}
+};
+
+class LTC298X : private LTC298XOwnSPI, public LTC298XDevice {
+	public:
+		LTC298X(uint8_t cs);
+		LTC298X(uint8_t cs, uint8_t irq);
 };
 
 #endif //LTC298X_H
\ No newline at end of file
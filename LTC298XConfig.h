@@ -0,0 +1,218 @@
+#ifndef LTC298XCONFIG_H
+#define LTC298XCONFIG_H
+#include "LTC298X.h"
+
+/****************************************************
+
+Compile-time channel assignments for the LTC298X library.
+Every sensor template validates its parameters with
+static_assert and provides the 32 bit channel word, an
+LTC298XConfigImage collects them into a PROGMEM image
+that LTC298X::loadConfig() uploads with a single burst.
+
+typedef LTC298XThermocouple<4, LTC298X_TYPE_TC_K, 2, true> TC1;
+typedef LTC298XDiode<2, true, false, false, DIODE_CURRENT_10uA> CJ;
+typedef LTC298XConfigImage<TC1, CJ> Config;
+sensor.loadConfig(Config::words);
+
+Custom tables are written with the LTC298X_ROW_* macros
+into PROGMEM arrays and uploaded with LTC298X::loadTable(),
+table addresses count 4 byte words from 0x250.
+
+*****************************************************/
+
+//Fixed point arguments for the templates
+#define LTC298X_IDEALITY(x)      ((uint32_t)((x) * 1048576)) //2,20
+#define LTC298X_OHM(x)           ((uint32_t)((x) * 1024))    //17,10
+
+//Custom table rows, 6 byte each
+#define LTC298X_ROW24(v)         (uint8_t)((uint32_t)(v) >> 16), (uint8_t)((uint32_t)(v) >> 8), (uint8_t)(v)
+//converted to an integer before ROW24 splits it, a double out of range of uint8_t must not be cast directly
+#define LTC298X_ROW_TC(mV, kelvin)          LTC298X_ROW24((int32_t)((mV) * 16384)), LTC298X_ROW24((uint32_t)((kelvin) * 1024))
+#define LTC298X_ROW_RTD(ohm, kelvin)        LTC298X_ROW24((uint32_t)((ohm) * 2048)), LTC298X_ROW24((uint32_t)((kelvin) * 1024))
+#define LTC298X_ROW_THERMISTOR(ohm, kelvin) LTC298X_ROW24((uint32_t)((ohm) * 16)), LTC298X_ROW24((uint32_t)((kelvin) * 1024))
+
+/*
+ * Channel word layout, shared with the runtime setup functions
+ */
+struct LTC298XWord {
+	static constexpr uint32_t diode(bool single_end, bool measure_three, bool average, uint8_t current, uint32_t ideality) {
+		return (uint32_t)LTC298X_TYPE_DIODE << 27 | //B[31:27]
+		       (uint32_t)single_end << 26 |         //B[26:26]
+		       (uint32_t)measure_three << 25 |      //B[25:25]
+		       (uint32_t)average << 24 |            //B[24:24]
+		       (uint32_t)current << 22 |            //B[23:22]
+		       ideality;                            //B[21:00] 2,20 fixed point fraction
+	}
+	static constexpr uint32_t senseResistor(uint32_t resistance) {
+		return (uint32_t)LTC298X_TYPE_SENSERES << 27 | //B[31:27]
+		       resistance;                             //B[26:00] 17,10 fixed point fraction
+	}
+	static constexpr uint32_t thermocouple(uint8_t type, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current, uint8_t addr, uint8_t len) {
+		return (uint32_t)type << 27 |       //B[31:27]
+		       (uint32_t)cj_ch << 22 |      //B[26:22]
+		       (uint32_t)single_end << 21 | //B[21:21]
+		       (uint32_t)oc_detect << 20 |  //B[20:20]
+		       (uint32_t)oc_current << 18 | //B[19:18]
+		       (uint32_t)addr << 6 |        //B[11:06] custom table only
+		       len;                         //B[05:00] custom table only
+	}
+	static constexpr uint32_t rtd(uint8_t type, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, uint8_t curve, uint8_t addr, uint8_t len) {
+		return (uint32_t)type << 27 |        //B[31:27]
+		       (uint32_t)sr_ch << 22 |       //B[26:22]
+		       (uint32_t)(wires - 2) << 20 | //B[21:20]
+		       (uint32_t)mode << 18 |        //B[19:18]
+		       (uint32_t)current << 14 |     //B[17:14]
+		       (uint32_t)curve << 12 |       //B[13:12]
+		       (uint32_t)addr << 6 |         //B[11:06] custom table only
+		       len;                          //B[05:00] custom table only
+	}
+	static constexpr uint32_t thermistor(uint8_t type, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, uint8_t addr, uint8_t len) {
+		return (uint32_t)type << 27 |       //B[31:27]
+		       (uint32_t)sr_ch << 22 |      //B[26:22]
+		       (uint32_t)single_end << 21 | //B[21:21]
+		       (uint32_t)mode << 19 |       //B[20:19]
+		       (uint32_t)current << 15 |    //B[18:15]
+		       (uint32_t)addr << 6 |        //B[11:06] custom table and Steinhart-Hart only
+		       len;                         //B[05:00] custom table and Steinhart-Hart only
+	}
+	static constexpr uint32_t adc(bool single_end) {
+		return (uint32_t)LTC298X_TYPE_ADC << 27 | //B[31:27]
+		       (uint32_t)single_end << 26;        //B[26:26]
+	}
+};
+
+/*
+ * Sensor templates, same parameters and limits as the runtime setup functions
+ */
+template<uint8_t ch, bool single_end, bool measure_three, bool average, uint8_t current, uint32_t ideality = 0>
+struct LTC298XDiode {
+	static_assert(ch >= 2 - single_end && ch <= 20, "diode channel out of range");
+	static_assert(current <= DIODE_CURRENT_80uA, "invalid diode current");
+	static_assert(ideality < LTC298X_IDEALITY(4), "ideality must be less than 4");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::diode(single_end, measure_three, average, current, ideality);
+};
+
+template<uint8_t ch, uint32_t resistance>
+struct LTC298XSenseResistor {
+	static_assert(ch >= 2 && ch <= 20, "sense resistor channel out of range");
+	static_assert(resistance < LTC298X_OHM(131072), "resistance must be less than 131.072 MOhm");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::senseResistor(resistance);
+};
+
+template<uint8_t ch, uint8_t type, uint8_t cj_ch, bool single_end, bool oc_detect = false, uint8_t oc_current = TC_CURRENT_10uA>
+struct LTC298XThermocouple {
+	static_assert(ch >= 2 - single_end && ch <= 20, "thermocouple channel out of range");
+	static_assert(cj_ch <= 20, "cold junction channel out of range");
+	static_assert(type >= LTC298X_TYPE_TC_J && type <= LTC298X_TYPE_TC_B, "not a thermocouple type");
+	static_assert(oc_current <= TC_CURRENT_1mA, "invalid open circuit current");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::thermocouple(type, cj_ch, single_end, oc_detect, oc_current, 0, 0);
+};
+
+template<uint8_t ch, uint8_t cj_ch, bool single_end, bool oc_detect, uint8_t oc_current, uint8_t addr, uint8_t rows>
+struct LTC298XCustomThermocouple {
+	static_assert(ch >= 2 - single_end && ch <= 20, "thermocouple channel out of range");
+	static_assert(cj_ch <= 20, "cold junction channel out of range");
+	static_assert(oc_current <= TC_CURRENT_1mA, "invalid open circuit current");
+	static_assert(rows >= 3 && rows <= 64 && addr <= LTC298X_MAX_ADDR_OFFSET && addr * 4 + rows * 6 <= LTC298X_RAM_SIZE, "custom table does not fit");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::thermocouple(LTC298X_TYPE_TC_CUST, cj_ch, single_end, oc_detect, oc_current, addr, rows - 1);
+};
+
+template<uint8_t ch, uint8_t type, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, uint8_t curve>
+struct LTC298XRTD {
+	static_assert(wires >= 2 && wires <= 5, "RTDs have 2 to 4 wires, 5 for 4-wire with Kelvin Rsense");
+	static_assert(ch >= 2 + (wires > 2), "RTD channel too low for this wiring");
+	static_assert(ch + (wires >= 4) <= 20, "RTD channel too high for this wiring");
+	static_assert(sr_ch >= 2 && sr_ch <= 20, "sense resistor channel out of range");
+	static_assert(mode <= LTC298X_MODE_CS_SR && !(wires < 4 && mode == LTC298X_MODE_CS_SR), "current source rotation needs 4 wires");
+	static_assert(type >= LTC298X_TYPE_PT_10 && type <= LTC298X_TYPE_NI_120, "not an RTD type");
+	static_assert(current >= RTD_CURRENT_5uA && current <= RTD_CURRENT_1mA, "invalid RTD current");
+	static_assert(curve <= RTD_CURVE_ITS_90, "invalid RTD curve");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::rtd(type, sr_ch, wires, mode, current, curve, 0, 0);
+};
+
+template<uint8_t ch, uint8_t sr_ch, uint8_t wires, uint8_t mode, uint8_t current, uint8_t addr, uint8_t rows>
+struct LTC298XCustomRTD {
+	static_assert(wires >= 2 && wires <= 5, "RTDs have 2 to 4 wires, 5 for 4-wire with Kelvin Rsense");
+	static_assert(ch >= 2 + (wires > 2), "RTD channel too low for this wiring");
+	static_assert(ch + (wires >= 4) <= 20, "RTD channel too high for this wiring");
+	static_assert(sr_ch >= 2 && sr_ch <= 20, "sense resistor channel out of range");
+	static_assert(mode <= LTC298X_MODE_CS_SR && !(wires == 2 && mode == LTC298X_MODE_CS_SR), "current source rotation needs more than 2 wires");
+	static_assert(current >= RTD_CURRENT_5uA && current <= RTD_CURRENT_1mA, "invalid RTD current");
+	static_assert(rows >= 3 && rows <= 64 && addr <= LTC298X_MAX_ADDR_OFFSET && addr * 4 + rows * 6 <= LTC298X_RAM_SIZE, "custom table does not fit");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::rtd(LTC298X_TYPE_RTD_CUST, sr_ch, wires, mode, current, 0, addr, rows - 1);
+};
+
+template<uint8_t ch, uint8_t type, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current>
+struct LTC298XThermistor {
+	static_assert(ch >= 2 - single_end && ch <= 20, "thermistor channel out of range");
+	static_assert(sr_ch >= 2 && sr_ch <= 20, "sense resistor channel out of range");
+	static_assert(mode <= LTC298X_MODE_CS_SR, "invalid excitation mode");
+	static_assert(current >= TR_CURRENT_250nA && current <= TR_CURRENT_AUTO, "invalid thermistor current");
+	static_assert(type >= LTC298X_TYPE_THER_44004 && type <= LTC298X_TYPE_THER_SPECT, "not a predefined thermistor type");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::thermistor(type, sr_ch, single_end, mode, current, 0, 0);
+};
+
+template<uint8_t ch, uint8_t sr_ch, bool single_end, uint8_t mode, uint8_t current, uint8_t addr, uint8_t rows>
+struct LTC298XCustomThermistor {
+	static_assert(ch >= 2 - single_end && ch <= 20, "thermistor channel out of range");
+	static_assert(sr_ch >= 2 && sr_ch <= 20, "sense resistor channel out of range");
+	static_assert(mode <= LTC298X_MODE_CS_SR, "invalid excitation mode");
+	static_assert(current >= TR_CURRENT_250nA && current <= TR_CURRENT_AUTO, "invalid thermistor current");
+	static_assert(rows >= 3 && rows <= 64 && addr <= LTC298X_MAX_ADDR_OFFSET && addr * 4 + rows * 6 <= LTC298X_RAM_SIZE, "custom table does not fit");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::thermistor(LTC298X_TYPE_THER_CUST, sr_ch, single_end, mode, current, addr, rows - 1);
+};
+
+template<uint8_t ch, bool single_end>
+struct LTC298XADC {
+	static_assert(ch >= 2 - single_end && ch <= 20, "ADC channel out of range");
+	static constexpr uint8_t channel = ch;
+	static constexpr uint32_t word = LTC298XWord::adc(single_end);
+};
+
+/*
+ * Image of all 20 channel words, unlisted channels are disabled
+ */
+template<typename... Channels>
+struct LTC298XImageWords;
+template<>
+struct LTC298XImageWords<> {
+	static constexpr uint32_t at(uint8_t) { return 0; }
+	static constexpr uint8_t count(uint8_t) { return 0; }
+};
+template<typename Head, typename... Tail>
+struct LTC298XImageWords<Head, Tail...> {
+	static constexpr uint32_t at(uint8_t ch) {
+		return Head::channel == ch ? Head::word : LTC298XImageWords<Tail...>::at(ch);
+	}
+	static constexpr uint8_t count(uint8_t ch) {
+		return (Head::channel == ch) + LTC298XImageWords<Tail...>::count(ch);
+	}
+	static constexpr bool unique(uint8_t ch = 1) {
+		return ch > 20 || (count(ch) <= 1 && unique(ch + 1));
+	}
+};
+
+template<typename... Channels>
+struct LTC298XConfigImage {
+	typedef LTC298XImageWords<Channels...> Words;
+	static_assert(sizeof...(Channels) > 0 && Words::unique(), "channel assigned twice");
+	static const uint32_t words[20];
+};
+template<typename... Channels>
+const uint32_t LTC298XConfigImage<Channels...>::words[20] PROGMEM = {
+	Words::at(1),  Words::at(2),  Words::at(3),  Words::at(4),  Words::at(5),
+	Words::at(6),  Words::at(7),  Words::at(8),  Words::at(9),  Words::at(10),
+	Words::at(11), Words::at(12), Words::at(13), Words::at(14), Words::at(15),
+	Words::at(16), Words::at(17), Words::at(18), Words::at(19), Words::at(20)
+};
+
+#endif //LTC298XCONFIG_H
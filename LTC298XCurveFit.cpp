@@ -0,0 +1,191 @@
+#include "LTC298XCurveFit.h"
+#include <math.h>
+
+/*
+ * Values as stored by the custom table upload: x truncated to the format, kelvin to 14,10
+ */
+static double quantizeX(double x, uint8_t format) {
+	double scale = format == LTC298X_FIT_THERMOCOUPLE ? 16384 : format == LTC298X_FIT_RTD ? 2048 : 16;
+	return (int32_t)(x * scale) / scale;
+}
+static double quantizeKelvin(double kelvin) {
+	return (uint32_t)(kelvin * 1024) / 1024.0;
+}
+/*
+ * Largest error of the points between i and j against the segment from i to j, -1 if the segment is not usable
+ */
+static double segmentError(const double* x, const double* kelvin, uint16_t i, uint16_t j, uint8_t format, double limit) {
+	double x0 = quantizeX(x[i], format);
+	double x1 = quantizeX(x[j], format);
+	double k0 = quantizeKelvin(kelvin[i]);
+	double k1 = quantizeKelvin(kelvin[j]);
+	if (x1 <= x0 || k1 <= k0) return -1; //rows must be increasing after quantization
+	double slope = (k1 - k0) / (x1 - x0);
+	double worst = 0;
+	for (uint16_t k = i + 1; k < j; k++) {
+		double error = fabs(k0 + (x[k] - x0) * slope - kelvin[k]);
+		if (error > worst) worst = error;
+		if (worst > limit) break;
+	}
+	return worst;
+}
+
+/*
+ * Select the fewest points (at least 3) of a curve whose linear interpolation deviates at most max_error kelvin
+ * from every point of the curve, with the table values quantized as uploaded.
+ * Params:
+ * x, kelvin    | Dense curve, x (mV or ohm) and kelvin monotonically increasing
+ * num_values   | Points of the curve
+ * format       | Format of x, any of LTC298X_FIT_THERMOCOUPLE, LTC298X_FIT_RTD, LTC298X_FIT_THERMISTOR
+ * max_error    | Allowed error in kelvin
+ * x_out        | Receives the selected x values
+ * kelvin_out   | Receives the selected kelvin values
+ * max_rows     | Capacity of x_out and kelvin_out, at most LTC298X_FIT_MAX_ROWS are used
+ * work         | 2 * num_values entries
+ * Returns the number of rows or 0 if the budget can not be met with max_rows points.
+ * Dynamic programming over all segments, O(num_values³) in the worst case.
+ */
+uint8_t LTC298XCurveFit::fitTable(const double* x, const double* kelvin, uint16_t num_values, uint8_t format, double max_error,
+                                  double* x_out, double* kelvin_out, uint8_t max_rows, uint16_t* work) {
+	if (num_values < 3) return 0; //invalid
+	if (max_rows > LTC298X_FIT_MAX_ROWS) max_rows = LTC298X_FIT_MAX_ROWS;
+	for (uint16_t i = 0; i < num_values; i++) {
+		if (fabs(quantizeKelvin(kelvin[i]) - kelvin[i]) > max_error) return 0; //budget below the table resolution
+	}
+	uint16_t* count = work;            //points of the best fit ending at j
+	uint16_t* prev = work + num_values; //point before j in it
+	count[0] = 1;
+	for (uint16_t j = 1; j < num_values; j++) {
+		count[j] = 0xFFFF;
+		for (uint16_t i = 0; i < j; i++) {
+			if (count[i] == 0xFFFF || count[i] + 1 >= count[j]) continue;
+			double error = segmentError(x, kelvin, i, j, format, max_error);
+			if (error < 0 || error > max_error) continue;
+			count[j] = count[i] + 1;
+			prev[j] = i;
+		}
+	}
+	uint16_t last = num_values - 1;
+	if (count[last] == 2) {
+		//a straight line, the chip needs 3 rows
+		for (uint16_t m = 1; m < last && count[last] == 2; m++) {
+			double e0 = segmentError(x, kelvin, 0, m, format, max_error);
+			double e1 = segmentError(x, kelvin, m, last, format, max_error);
+			if (e0 < 0 || e1 < 0 || e0 > max_error || e1 > max_error) continue;
+			count[last] = 3;
+			prev[last] = m;
+			count[m] = 2;
+			prev[m] = 0;
+		}
+		if (count[last] == 2) return 0;
+	}
+	if (count[last] > max_rows) return 0;
+	uint8_t rows = count[last];
+	uint16_t j = last;
+	for (uint8_t r = rows; r > 0; r--) {
+		x_out[r - 1] = x[j];
+		kelvin_out[r - 1] = kelvin[j];
+		j = prev[j];
+	}
+	return rows;
+}
+/*
+ * Largest error in kelvin of a table against a dense curve within the range of the table
+ */
+double LTC298XCurveFit::tableError(const double* x, const double* kelvin, uint16_t num_values, uint8_t format,
+                                   const double* x_table, const double* kelvin_table, uint8_t rows) {
+	double worst = 0;
+	uint8_t r = 0;
+	for (uint16_t i = 0; i < num_values; i++) {
+		while (r + 2 < rows && x[i] > quantizeX(x_table[r + 1], format)) r++;
+		double x0 = quantizeX(x_table[r], format);
+		double x1 = quantizeX(x_table[r + 1], format);
+		double k0 = quantizeKelvin(kelvin_table[r]);
+		double k1 = quantizeKelvin(kelvin_table[r + 1]);
+		double error = fabs(k0 + (x[i] - x0) * (k1 - k0) / (x1 - x0) - kelvin[i]);
+		if (error > worst) worst = error;
+	}
+	return worst;
+}
+
+/*
+ * Least squares fit of the Steinhart-Hart coefficients selected by terms (B0 = A ... B5 = F, others are 0).
+ * Rows are weighted with T², so the fit minimizes the temperature error instead of the error of 1/T.
+ * Params:
+ * ohm, kelvin  | Calibration points
+ * num_values   | At least as many as selected terms
+ * terms        | LTC298X_FIT_SH_ALL, LTC298X_FIT_SH_CLASSIC or any other mask
+ * coeff        | Receives A-F as single precision floats, as uploaded
+ * work         | 7 * num_values entries
+ * Returns the largest error in kelvin with the rounded coefficients, negative if the fit failed.
+ * Solved with Householder QR on normalized columns, which stays accurate where the normal equations would not.
+ */
+double LTC298XCurveFit::fitSteinhartHart(const double* ohm, const double* kelvin, uint16_t num_values, uint8_t terms,
+                                         float coeff[6], double* work) {
+	uint8_t power[6];
+	uint8_t cols = 0;
+	for (uint8_t p = 0; p < 6; p++) {
+		if (terms & (1 << p)) power[cols++] = p;
+	}
+	if (!cols || num_values < cols) return -1; //invalid
+	uint16_t n = num_values;
+	double* a = work; //column major n x cols
+	double* b = work + 6 * n;
+	double norm[6];
+	for (uint16_t i = 0; i < n; i++) {
+		if (ohm[i] <= 0 || kelvin[i] <= 0) return -1; //invalid
+		double weight = kelvin[i] * kelvin[i];
+		double ln = log(ohm[i]);
+		for (uint8_t c = 0; c < cols; c++) a[c * n + i] = pow(ln, power[c]) * weight;
+		b[i] = weight / kelvin[i];
+	}
+	for (uint8_t c = 0; c < cols; c++) {
+		double sum = 0;
+		for (uint16_t i = 0; i < n; i++) sum += a[c * n + i] * a[c * n + i];
+		norm[c] = sqrt(sum);
+		if (norm[c] == 0) return -1; //singular
+		for (uint16_t i = 0; i < n; i++) a[c * n + i] /= norm[c];
+	}
+	//reduce to upper triangular R, applying the same reflections to b
+	for (uint8_t c = 0; c < cols; c++) {
+		double* col = a + c * n;
+		double sum = 0;
+		for (uint16_t i = c; i < n; i++) sum += col[i] * col[i];
+		double alpha = col[c] > 0 ? -sqrt(sum) : sqrt(sum);
+		if (alpha == 0) return -1; //singular
+		//v = x - alpha e1 stored in place, |v|² = 2 (|x|² - alpha x1)
+		double v_norm = 2 * (sum - alpha * col[c]);
+		col[c] -= alpha;
+		for (uint8_t d = c + 1; d <= cols; d++) {
+			double* other = d < cols ? a + d * n : b;
+			double dot = 0;
+			for (uint16_t i = c; i < n; i++) dot += col[i] * other[i];
+			double f = 2 * dot / v_norm;
+			for (uint16_t i = c; i < n; i++) other[i] -= f * col[i];
+		}
+		col[c] = alpha; //diagonal of R, the rest of v is not needed anymore
+	}
+	double solution[6];
+	for (int8_t c = cols - 1; c >= 0; c--) {
+		double sum = b[c];
+		for (uint8_t d = c + 1; d < cols; d++) sum -= a[d * n + c] * solution[d];
+		solution[c] = sum / a[c * n + c];
+	}
+	for (uint8_t p = 0; p < 6; p++) coeff[p] = 0;
+	for (uint8_t c = 0; c < cols; c++) coeff[power[c]] = (float)(solution[c] / norm[c]);
+	double worst = 0;
+	for (uint16_t i = 0; i < n; i++) {
+		double error = fabs(steinhartHart(coeff, ohm[i]) - kelvin[i]);
+		if (error > worst) worst = error;
+	}
+	return worst;
+}
+/*
+ * Temperature in kelvin of a thermistor with resistance ohm
+ */
+double LTC298XCurveFit::steinhartHart(const float coeff[6], double ohm) {
+	double ln = log(ohm);
+	double inverse = 0;
+	for (int8_t p = 5; p >= 0; p--) inverse = inverse * ln + coeff[p];
+	return 1 / inverse;
+}
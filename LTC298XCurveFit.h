@@ -0,0 +1,45 @@
+#ifndef LTC298XCURVEFIT_H
+#define LTC298XCURVEFIT_H
+#include <stdint.h>
+#include <stddef.h>
+
+/****************************************************
+
+Fitting of dense calibration curves to the custom
+sensor formats of the LTC298X. Meant for the host or
+for the calibration setup, the work buffers are passed
+in by the caller and only depend on the curve length.
+
+fitTable() selects the fewest points of a curve whose
+linear interpolation stays within an error budget,
+evaluated with the fixed point formats of the custom
+tables. The result is ready for setupCustomRTD(),
+setupCustomThermistor() or setupCustomThermocouple().
+
+fitSteinhartHart() fits the six coefficients of
+1/T = A + B ln R + C ln² R + D ln³ R + E ln⁴ R + F ln⁵ R
+for setupSteinhartHartThermistor() by least squares.
+
+*****************************************************/
+
+//x formats of the custom tables, see LTC298X_ROW_* in LTC298XConfig.h
+#define LTC298X_FIT_THERMOCOUPLE 0 //mV as signed 9,14
+#define LTC298X_FIT_RTD          1 //ohm as unsigned 13,11
+#define LTC298X_FIT_THERMISTOR   2 //ohm as unsigned 20,4
+
+#define LTC298X_FIT_MAX_ROWS     64
+#define LTC298X_FIT_SH_ALL       0x3F //all six coefficients
+#define LTC298X_FIT_SH_CLASSIC   0x0B //A, B and D
+
+class LTC298XCurveFit {
+	public:
+		static uint8_t fitTable(const double* x, const double* kelvin, uint16_t num_values, uint8_t format, double max_error,
+		                        double* x_out, double* kelvin_out, uint8_t max_rows, uint16_t* work);
+		static double tableError(const double* x, const double* kelvin, uint16_t num_values, uint8_t format,
+		                         const double* x_table, const double* kelvin_table, uint8_t rows);
+		static double fitSteinhartHart(const double* ohm, const double* kelvin, uint16_t num_values, uint8_t terms,
+		                               float coeff[6], double* work);
+		static double steinhartHart(const float coeff[6], double ohm);
+};
+
+#endif //LTC298XCURVEFIT_H
@@ -0,0 +1,101 @@
+#include "LTC298XFilter.h"
+
+static int32_t unscale(int32_t state) {
+	return (state + ((int32_t)1 << (LTC298X_FILTER_FRAC - 1))) >> LTC298X_FILTER_FRAC;
+}
+
+/*
+ * shift | Smoothing, 0 (none) to 16, time constant about 2^shift samples
+ */
+LTC298XEmaFilter::LTC298XEmaFilter(uint8_t shift) : _shift(shift > 16 ? 16 : shift) {}
+
+int32_t LTC298XEmaFilter::update(int32_t raw) {
+	if (!_primed) {
+		_sum = (int64_t)raw << _shift;
+		_primed = true;
+	} else {
+		_sum += raw - (_sum >> _shift); //settles exactly on a constant input
+	}
+	return (int32_t)(_sum >> _shift);
+}
+void LTC298XEmaFilter::reset(void) {
+	_primed = false;
+}
+
+int32_t LTC298XMedianBase::update(int32_t raw, int32_t* window, int32_t* sorted, uint8_t size) {
+	uint8_t n = _count;
+	if (_count == size) {
+		//remove the oldest sample from the sorted copy
+		uint8_t i = 0;
+		while (sorted[i] != window[_pos]) i++;
+		for (; i + 1 < n; i++) sorted[i] = sorted[i + 1];
+		n--;
+	} else {
+		_count++;
+	}
+	window[_pos] = raw;
+	if (++_pos == size) _pos = 0;
+	//insert the new one
+	uint8_t i = n;
+	while (i && sorted[i - 1] > raw) {
+		sorted[i] = sorted[i - 1];
+		i--;
+	}
+	sorted[i] = raw;
+	n++;
+	if (n & 1) return sorted[n / 2];
+	return (int32_t)(((int64_t)sorted[n / 2 - 1] + sorted[n / 2]) / 2); //even window or still filling
+}
+void LTC298XMedianBase::reset(void) {
+	_count = 0;
+	_pos = 0;
+}
+
+LTC298XKalmanFilter::LTC298XKalmanFilter(uint32_t q, uint32_t r) : _q(q), _r(r ? r : 1) {}
+
+int32_t LTC298XKalmanFilter::update(int32_t raw) {
+	int32_t x = raw * ((int32_t)1 << LTC298X_FILTER_FRAC);
+	if (!_primed) {
+		_state = x;
+		_p = _r;
+		_primed = true;
+		return raw;
+	}
+	//predict
+	uint64_t p = (uint64_t)_p + _q;
+	//update with gain k = p / (p + r) as 0,16 fixed point fraction
+	uint32_t k = (uint32_t)((p << 16) / (p + _r));
+	_state += (int32_t)((((int64_t)x - _state) * k) >> 16);
+	p = (p * (65536 - k)) >> 16;
+	_p = p > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)p;
+	return unscale(_state);
+}
+void LTC298XKalmanFilter::reset(void) {
+	_primed = false;
+}
+
+/*
+ * Filter results of ch (1-20) with filter, NULL to pass them unfiltered
+ */
+bool LTC298XFilterBank::set(uint8_t ch, LTC298XFilter* filter) {
+	if (ch > 20 || ch == 0) return false; //invalid
+	_filters[ch - 1] = filter;
+	if (filter) filter->reset();
+	return true;
+}
+LTC298XFilter* LTC298XFilterBank::get(uint8_t ch) {
+	if (ch > 20 || ch == 0) return NULL;
+	return _filters[ch - 1];
+}
+int32_t LTC298XFilterBank::update(uint8_t ch, int32_t raw) {
+	LTC298XFilter* filter = this->get(ch);
+	return filter ? filter->update(raw) : raw;
+}
+/*
+ * Restart all filters, e.g. after the channel assignments changed
+ */
+void LTC298XFilterBank::reset(void) {
+	for (uint8_t i = 0; i < 20; i++) {
+		if (_filters[i]) _filters[i]->reset();
+	}
+}
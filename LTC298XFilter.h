@@ -0,0 +1,108 @@
+#ifndef LTC298XFILTER_H
+#define LTC298XFILTER_H
+#include <Arduino.h>
+
+/****************************************************
+
+Per-channel digital filters for the LTC298X library.
+All filters work on the raw 24 bit results in integer
+or fixed point arithmetic, are updated sample by sample
+and keep their state in the object, no heap is used.
+A filter bank attached to a device filters every valid
+result read by poll() before it is handed on.
+
+LTC298XEmaFilter tc_filter(3);
+LTC298XMedianFilter<5> rtd_filter;
+LTC298XFilterBank bank;
+bank.set(4, &tc_filter);
+bank.set(6, &rtd_filter);
+sensor.setFilterBank(&bank);
+
+*****************************************************/
+
+#define LTC298X_FILTER_FRAC      6 //fraction bits of the Kalman state, raw results use 24 bit
+
+class LTC298XFilter {
+	public:
+		virtual ~LTC298XFilter(void) {}
+		virtual int32_t update(int32_t raw) = 0;
+		virtual void reset(void) = 0;
+};
+
+/*
+ * Exponential moving average, y += (x - y) / 2^shift
+ * The state keeps y·2^shift, so it has shift fraction bits.
+ */
+class LTC298XEmaFilter : public LTC298XFilter {
+	private:
+		uint8_t _shift;
+		bool _primed = false;
+		int64_t _sum;
+		
+	public:
+		LTC298XEmaFilter(uint8_t shift);
+		virtual int32_t update(int32_t raw);
+		virtual void reset(void);
+};
+
+/*
+ * Moving median over the last samples, removes single spikes. A sorted copy of the window is kept
+ * and updated by removing the oldest and inserting the newest sample.
+ */
+class LTC298XMedianBase : public LTC298XFilter {
+	private:
+		uint8_t _count = 0;
+		uint8_t _pos = 0;
+		
+	protected:
+		int32_t update(int32_t raw, int32_t* window, int32_t* sorted, uint8_t size);
+		
+	public:
+		virtual void reset(void);
+};
+template<uint8_t size>
+class LTC298XMedianFilter : public LTC298XMedianBase {
+	private:
+		int32_t _window[size];
+		int32_t _sorted[size];
+		
+	public:
+		virtual int32_t update(int32_t raw) {
+			return LTC298XMedianBase::update(raw, _window, _sorted, size);
+		}
+};
+
+/*
+ * Scalar Kalman filter for a constant value.
+ * q  | Process noise, variance in LSB² the value may drift per sample
+ * r  | Measurement noise, variance in LSB² of a single result
+ */
+class LTC298XKalmanFilter : public LTC298XFilter {
+	private:
+		uint32_t _q;
+		uint32_t _r;
+		uint32_t _p;
+		bool _primed = false;
+		int32_t _state;
+		
+	public:
+		LTC298XKalmanFilter(uint32_t q, uint32_t r);
+		virtual int32_t update(int32_t raw);
+		virtual void reset(void);
+};
+
+/*
+ * One optional filter per channel
+ */
+class LTC298XFilterBank {
+	private:
+		LTC298XFilter* _filters[20] = {NULL};
+		
+	public:
+		bool set(uint8_t ch, LTC298XFilter* filter);
+		LTC298XFilter* get(uint8_t ch);
+		int32_t update(uint8_t ch, int32_t raw);
+		void reset(void);
+};
+
+#endif //LTC298XFILTER_H
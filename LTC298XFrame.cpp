@@ -0,0 +1,144 @@
+#include "LTC298XFrame.h"
+
+static uint16_t frameCrc(const uint8_t* buf, uint16_t len) {
+	uint16_t crc = 0xFFFF;
+	for (uint16_t i = 0; i < len; i++) {
+		crc ^= (uint16_t)buf[i] << 8;
+		for (uint8_t j = 0; j < 8; j++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+static uint8_t* putBitmap(uint8_t* p, uint32_t bits) {
+	p[0] = bits >> 16;
+	p[1] = bits >> 8;
+	p[2] = bits;
+	return p + 3;
+}
+static uint32_t getBitmap(const uint8_t* p) {
+	return (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+}
+/*
+ * Zigzag maps small negative and positive numbers to small unsigned ones, 7 bits per byte with B7 = more to follow
+ */
+static uint8_t* putVarint(uint8_t* p, int32_t value) {
+	uint32_t zz = ((uint32_t)value << 1) ^ (0 - ((uint32_t)value >> 31));
+	while (zz >= 0x80) {
+		*p++ = (uint8_t)zz | 0x80;
+		zz >>= 7;
+	}
+	*p++ = zz;
+	return p;
+}
+static const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, int32_t* value) {
+	uint32_t zz = 0;
+	for (uint8_t shift = 0; shift < 35; shift += 7) {
+		if (p >= end) return NULL; //truncated
+		uint8_t b = *p++;
+		zz |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80)) {
+			*value = (int32_t)((zz >> 1) ^ (0 - (zz & 1)));
+			return p;
+		}
+	}
+	return NULL; //too long
+}
+
+/*
+ * key_interval | Frames between two key frames, 0 or 1 for key frames only
+ */
+LTC298XFrameEncoder::LTC298XFrameEncoder(uint8_t key_interval) : _key_interval(key_interval) {}
+
+/*
+ * Encode one scan into buf (at least LTC298X_FRAME_MAX byte), arrays are indexed by ch - 1
+ * as for the onScanComplete() callback. Returns the frame length, 0 if mask is invalid.
+ */
+uint8_t LTC298XFrameEncoder::encode(uint32_t mask, const int32_t* raw, const uint8_t* status, uint8_t* buf) {
+	if (mask >= 0x100000) return 0; //invalid
+	bool delta = mask && mask == _prev_mask && _since_key + 1 < _key_interval;
+	uint32_t faults = 0;
+	for (uint8_t i = 0; i < 20; i++) {
+		if ((mask & ((uint32_t)1 << i)) && status[i] != LTC298X_FRAME_STATUS_OK) faults |= (uint32_t)1 << i;
+	}
+	uint8_t* p = buf;
+	*p++ = LTC298X_FRAME_SYNC;
+	*p++ = 0; //length, set below
+	*p++ = LTC298X_FRAME_VERSION << 4 | (delta ? LTC298X_FRAME_DELTA : 0);
+	*p++ = _seq++;
+	p = putBitmap(p, mask);
+	p = putBitmap(p, faults);
+	for (uint8_t i = 0; i < 20; i++) {
+		if (faults & ((uint32_t)1 << i)) *p++ = status[i];
+	}
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(mask & ((uint32_t)1 << i))) continue;
+		p = putVarint(p, delta ? (int32_t)((uint32_t)raw[i] - (uint32_t)_prev[i]) : raw[i]);
+		_prev[i] = raw[i];
+	}
+	_prev_mask = mask;
+	_since_key = delta ? _since_key + 1 : 0;
+	uint8_t len = p - buf + 2;
+	buf[1] = len;
+	uint16_t crc = frameCrc(buf, len - 2);
+	*p++ = crc >> 8;
+	*p = crc;
+	return len;
+}
+/*
+ * Start over with a key frame, e.g. after the receiver was reconnected
+ */
+void LTC298XFrameEncoder::reset(void) {
+	_prev_mask = 0;
+}
+
+/*
+ * Decode one frame of len byte, buf[1] holds the length of a frame found by its sync byte in a stream.
+ * Only entries of channels in mask are written. Returns false for corrupted frames
+ * and for delta frames without the frame before, decoding resumes with the next key frame.
+ */
+bool LTC298XFrameDecoder::decode(const uint8_t* buf, uint16_t len, uint32_t* mask, int32_t* raw, uint8_t* status) {
+	if (len < LTC298X_FRAME_HEADER + 2 ||
+	    buf[0] != LTC298X_FRAME_SYNC ||
+	    buf[1] != len ||
+	    buf[2] >> 4 != LTC298X_FRAME_VERSION ||
+	    frameCrc(buf, len - 2) != ((uint16_t)buf[len - 2] << 8 | buf[len - 1])
+	) return false; //invalid
+	bool delta = buf[2] & LTC298X_FRAME_DELTA;
+	uint32_t channels = getBitmap(buf + 4);
+	uint32_t faults = getBitmap(buf + 7);
+	if (channels >= 0x100000 || (faults & ~channels)) return false; //invalid
+	if (delta && (channels != _prev_mask || buf[3] != (uint8_t)(_seq + 1))) {
+		_prev_mask = 0; //missed a frame, wait for the next key frame
+		return false;
+	}
+	const uint8_t* p = buf + LTC298X_FRAME_HEADER;
+	const uint8_t* end = buf + len - 2;
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(channels & ((uint32_t)1 << i))) continue;
+		if (!(faults & ((uint32_t)1 << i))) {
+			status[i] = LTC298X_FRAME_STATUS_OK;
+		} else {
+			if (p >= end) return false; //truncated
+			status[i] = *p++;
+		}
+	}
+	int32_t values[20];
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(channels & ((uint32_t)1 << i))) continue;
+		p = getVarint(p, end, &values[i]);
+		if (!p) return false; //truncated
+		if (delta) values[i] = (int32_t)((uint32_t)_prev[i] + (uint32_t)values[i]);
+	}
+	if (p != end) return false; //trailing bytes
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(channels & ((uint32_t)1 << i))) continue;
+		raw[i] = values[i];
+		_prev[i] = values[i];
+	}
+	_prev_mask = channels;
+	_seq = buf[3];
+	*mask = channels;
+	return true;
+}
+void LTC298XFrameDecoder::reset(void) {
+	_prev_mask = 0;
+}
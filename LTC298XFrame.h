@@ -0,0 +1,66 @@
+#ifndef LTC298XFRAME_H
+#define LTC298XFRAME_H
+#include <stdint.h>
+#include <stddef.h>
+
+/****************************************************
+
+Compact binary frames of LTC298X scan results for
+serial links. Only depends on stdint, the decoder
+builds on Linux as well.
+
+Layout, multi-byte fields big-endian:
+[0]     LTC298X_FRAME_SYNC
+[1]     frame length including sync and checksum
+[2]     B[7:4] version, B[0] values are deltas
+[3]     sequence number
+[4:6]   channel bitmap, B0 = channel 1
+[7:9]   bitmap of channels with a status other than
+        LTC298X_FRAME_STATUS_OK, followed by these
+        status bytes in channel order
+then    one zigzag varint per channel in channel order,
+        the raw result or its difference to the
+        previous frame
+last 2  CRC-16/CCITT over everything before
+
+Delta frames are only sent if the channel set did not
+change and the previous frame had the sequence number
+before. A key frame is sent every key_interval frames,
+so a receiver recovers from lost frames.
+
+*****************************************************/
+
+#define LTC298X_FRAME_SYNC       0xA5
+#define LTC298X_FRAME_VERSION    1
+#define LTC298X_FRAME_DELTA      0x01
+#define LTC298X_FRAME_HEADER     10
+#define LTC298X_FRAME_MAX        (LTC298X_FRAME_HEADER + 20 + 20 * 5 + 2) //worst case with 20 channels
+#define LTC298X_FRAME_STATUS_OK  0x01 //valid, no fault bits
+
+class LTC298XFrameEncoder {
+	private:
+		int32_t _prev[20];
+		uint32_t _prev_mask = 0;
+		uint8_t _seq = 0;
+		uint8_t _key_interval;
+		uint8_t _since_key = 0;
+		
+	public:
+		LTC298XFrameEncoder(uint8_t key_interval = 16);
+		
+		uint8_t encode(uint32_t mask, const int32_t* raw, const uint8_t* status, uint8_t* buf);
+		void reset(void);
+};
+
+class LTC298XFrameDecoder {
+	private:
+		int32_t _prev[20];
+		uint32_t _prev_mask = 0;
+		uint8_t _seq = 0;
+		
+	public:
+		bool decode(const uint8_t* buf, uint16_t len, uint32_t* mask, int32_t* raw, uint8_t* status);
+		void reset(void);
+};
+
+#endif //LTC298XFRAME_H
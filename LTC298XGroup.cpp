@@ -0,0 +1,91 @@
+#include "LTC298XGroup.h"
+
+LTC298XGroup::LTC298XGroup(void) : _bus(NULL) {}
+/*
+ * Pass the bus shared by the transports of all chips to open SPI.beginTransaction() only once per update().
+ */
+LTC298XGroup::LTC298XGroup(LTC298XSPIBus& bus) : _bus(&bus) {}
+
+/*
+ * Add a chip and the channels (same format as selectConversionChannels) to scan on it.
+ */
+bool LTC298XGroup::add(LTC298XDevice& device, uint32_t channels) {
+	if (_count >= LTC298X_GROUP_MAX ||
+	    !channels ||
+	    channels >= 0x100000
+	) return false; //invalid
+	_devices[_count] = &device;
+	_channels[_count] = channels;
+	_count++;
+	return true;
+}
+void LTC298XGroup::begin(void) {
+	for (uint8_t i = 0; i < _count; i++) _devices[i]->begin();
+}
+/*
+ * Start the chips one after another, spread over the longest conversion time of the group,
+ * so their readouts don't bunch up. The chips then free-run until stop().
+ */
+bool LTC298XGroup::start(void) {
+	if (!_count) return false;
+	uint32_t cycle = 0;
+	for (uint8_t i = 0; i < _count; i++) {
+		uint32_t us = _devices[i]->estimateConversionTime(_channels[i]);
+		if (us > cycle) cycle = us;
+	}
+	uint32_t now = micros();
+	_waiting = 0;
+	for (uint8_t i = 1; i < _count; i++) {
+		_start_at[i] = now + cycle / _count * i;
+		_waiting |= 1 << i;
+	}
+	if (_bus) _bus->hold();
+	_devices[0]->startScan(_channels[0]);
+	if (_bus) _bus->release();
+	_running = true;
+	return true;
+}
+/*
+ * No new conversions are started, running ones finish unread.
+ */
+void LTC298XGroup::stop(void) {
+	_running = false;
+	_waiting = 0;
+}
+/*
+ * Call frequently from loop(). Starts the staggered chips when due, reads every chip that finished and restarts it immediately.
+ * The bus is released before the callback, so it may use SPI for other devices.
+ * The chip checked first rotates, so no chip is starved by slow callbacks.
+ */
+void LTC298XGroup::update(void) {
+	if (!_running) return;
+	int32_t raw[20];
+	uint8_t status[20];
+	bool held = false;
+	uint32_t now = micros();
+	for (uint8_t k = 0; k < _count; k++) {
+		uint8_t i = (_next + k) % _count;
+		if (_bus && !held) {
+			_bus->hold();
+			held = true;
+		}
+		if (_waiting & (1 << i)) {
+			if ((int32_t)(now - _start_at[i]) < 0) continue;
+			_devices[i]->startScan(_channels[i]);
+			_waiting &= ~(1 << i);
+			continue;
+		}
+		if (!_devices[i]->poll(raw, status)) continue;
+		_devices[i]->startScan(_channels[i]);
+		if (held) {
+			_bus->release();
+			held = false;
+		}
+		if (_callback) _callback(i, _channels[i], raw, status);
+	}
+	if (held) _bus->release();
+	_next = (_next + 1) % _count;
+}
+void LTC298XGroup::onScanComplete(LTC298XGroupCallback callback) {
+	_callback = callback;
+}
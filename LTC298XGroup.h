@@ -0,0 +1,44 @@
+#ifndef LTC298XGROUP_H
+#define LTC298XGROUP_H
+#include "LTC298X.h"
+
+/****************************************************
+
+Continuous scanning of several LTC298X on one bus.
+The first conversions are staggered over one cycle
+and every chip is restarted right after its results
+are read, so readouts of one chip overlap the
+conversions of the others instead of running in series.
+
+*****************************************************/
+
+#define LTC298X_GROUP_MAX        8
+
+//device is the index in order of add(), arrays are indexed by ch - 1
+typedef void (*LTC298XGroupCallback)(uint8_t device, uint32_t mask, const int32_t* raw, const uint8_t* status);
+
+class LTC298XGroup {
+	private:
+		LTC298XSPIBus* _bus;
+		LTC298XDevice* _devices[LTC298X_GROUP_MAX];
+		uint32_t _channels[LTC298X_GROUP_MAX];
+		uint32_t _start_at[LTC298X_GROUP_MAX]; //micros() of the staggered first start
+		uint8_t _waiting = 0; //chips not started yet, B0 = first chip
+		uint8_t _count = 0;
+		uint8_t _next = 0;
+		bool _running = false;
+		LTC298XGroupCallback _callback = NULL;
+		
+	public:
+		LTC298XGroup(void);
+		LTC298XGroup(LTC298XSPIBus& bus);
+		
+		bool add(LTC298XDevice& device, uint32_t channels);
+		void begin(void);
+		bool start(void);
+		void stop(void);
+		void update(void);
+		void onScanComplete(LTC298XGroupCallback callback);
+};
+
+#endif //LTC298XGROUP_H
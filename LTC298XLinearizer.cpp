@@ -0,0 +1,67 @@
+#include "LTC298XLinearizer.h"
+
+LTC298XLinearizer::LTC298XLinearizer(const int32_t* values, int32_t base, int32_t first, int32_t last, uint8_t shift, uint16_t points) :
+	_values(values), _base(base), _first(first), _last(last), _shift(shift), _points(points) {}
+
+/*
+ * Interpolate between the two grid points around input, clamped to the ends of the curve
+ */
+static inline int32_t interpolate(const int32_t* values, int32_t x, int32_t first, int32_t last, uint8_t shift) {
+	x = x < first ? first : x;
+	x = x > last ? last : x;
+	uint16_t i = x >> shift;
+	int32_t low = pgm_read_dword(values + i);
+	int32_t high = pgm_read_dword(values + i + 1);
+	return low + (((high - low) * (x & (((int32_t)1 << shift) - 1))) >> shift);
+}
+
+/*
+ * Temperature in °C as 13,10 fixed point for an input in 2,21 fixed point
+ */
+int32_t LTC298XLinearizer::convert(int32_t input) const {
+	return interpolate(_values, input - _base, _first, _last, _shift);
+}
+/*
+ * Convert an array of inputs, offset is added to every input first (see toInput()).
+ * input and output may be the same array.
+ */
+void LTC298XLinearizer::convert(const int32_t* input, int32_t* output, uint16_t count, int32_t offset) const {
+	int32_t shifted = offset - _base;
+	for (uint16_t i = 0; i < count; i++) output[i] = interpolate(_values, input[i] + shifted, _first, _last, _shift);
+}
+/*
+ * Convert the results of readResults() or poll() in place.
+ * Params:
+ * mask   | Channels to convert, same format as selectConversionChannels
+ * raw    | Array of 20 results indexed by ch - 1
+ * status | Array of 20 status bytes, only valid results are converted, may be NULL to convert all
+ * offset | Added to every input, for thermocouples the cold junction voltage from toInput()
+ */
+void LTC298XLinearizer::apply(uint32_t mask, int32_t* raw, const uint8_t* status, int32_t offset) const {
+	int32_t shifted = offset - _base;
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(mask & ((uint32_t)1 << i)) || (status && !(status[i] & 0x01))) continue;
+		raw[i] = interpolate(_values, raw[i] + shifted, _first, _last, _shift);
+	}
+}
+/*
+ * Inverse of convert(), the input for a temperature in °C as 13,10 fixed point.
+ * For thermocouples this turns the cold junction temperature into the voltage to add to the measured one.
+ */
+int32_t LTC298XLinearizer::toInput(int32_t value) const {
+	uint16_t low = 0;
+	uint16_t high = _points - 1;
+	if (value <= (int32_t)pgm_read_dword(_values)) return _base + _first;
+	if (value >= (int32_t)pgm_read_dword(_values + high)) return _base + _last;
+	while (high - low > 1) {
+		uint16_t mid = (low + high) >> 1;
+		if ((int32_t)pgm_read_dword(_values + mid) <= value) low = mid;
+		else high = mid;
+	}
+	int32_t v0 = pgm_read_dword(_values + low);
+	int32_t v1 = pgm_read_dword(_values + high);
+	int32_t input = ((int32_t)low << _shift) + (((value - v0) << _shift) + ((v1 - v0) >> 1)) / (v1 - v0);
+	input = input < _first ? _first : input;
+	input = input > _last ? _last : input;
+	return _base + input;
+}
@@ -0,0 +1,247 @@
+#ifndef LTC298XLINEARIZER_H
+#define LTC298XLINEARIZER_H
+#include "LTC298X.h"
+
+/****************************************************
+
+Host side linearization of ADC channels for the
+LTC298X library. The curves of the standard
+thermocouples and of Callendar-Van Dusen RTDs are
+sampled at compile time into PROGMEM tables on a
+power of two grid of the 2,21 fixed point input, so
+a conversion is one shift, two table reads and a
+multiply. Results use the 13,10 format of the chip.
+
+typedef LTC298XThermocoupleCurve<LTC298X_TYPE_TC_K> TypeK;
+LTC298XLinearizer tc = LTC298XLinearizer::of<TypeK>();
+int32_t cj = tc.toInput(sensor.readRaw(2));
+tc.apply(LTC298X_CH4 | LTC298X_CH5, raw, status, cj);
+
+Thermocouple inputs are volts as returned by
+readADC channels, RTD inputs are the ratio R/R0.
+Inputs outside the curve are clamped to its ends.
+
+*****************************************************/
+
+/*
+ * Index sequence, built by halving so the template depth stays logarithmic
+ */
+template<uint16_t... I>
+struct LTC298XIndices {};
+template<typename A, typename B>
+struct LTC298XJoinIndices;
+template<uint16_t... A, uint16_t... B>
+struct LTC298XJoinIndices<LTC298XIndices<A...>, LTC298XIndices<B...> > {
+	typedef LTC298XIndices<A..., (uint16_t)(sizeof...(A) + B)...> type;
+};
+template<uint16_t N>
+struct LTC298XMakeIndices {
+	typedef typename LTC298XJoinIndices<typename LTC298XMakeIndices<N / 2>::type, typename LTC298XMakeIndices<N - N / 2>::type>::type type;
+};
+template<>
+struct LTC298XMakeIndices<0> {
+	typedef LTC298XIndices<> type;
+};
+template<>
+struct LTC298XMakeIndices<1> {
+	typedef LTC298XIndices<0> type;
+};
+
+/*
+ * NIST ITS-90 inverse polynomials, mV to °C
+ */
+struct LTC298XNist {
+	static constexpr double horner(double) { return 0; }
+	template<typename... C>
+	static constexpr double horner(double x, double c0, C... c) {
+		return c0 + x * horner(x, c...);
+	}
+	static constexpr double typeJ(double mV) {
+		return mV < 0 ? horner(mV, 0, 1.9528268E+01, -1.2286185E+00, -1.0752178E+00, -5.9086933E-01, -1.7256713E-01, -2.8131513E-02, -2.3963370E-03, -8.3823321E-05) :
+		       mV < 42.919 ? horner(mV, 0, 1.978425E+01, -2.001204E-01, 1.036969E-02, -2.549687E-04, 3.585153E-06, -5.344285E-08, 5.099890E-10) :
+		       horner(mV, -3.11358187E+03, 3.00543684E+02, -9.94773230E+00, 1.70276630E-01, -1.43033468E-03, 4.73886084E-06);
+	}
+	static constexpr double typeK(double mV) {
+		return mV < 0 ? horner(mV, 0, 2.5173462E+01, -1.1662878E+00, -1.0833638E+00, -8.9773540E-01, -3.7342377E-01, -8.6632643E-02, -1.0450598E-02, -5.1920577E-04) :
+		       mV < 20.644 ? horner(mV, 0, 2.508355E+01, 7.860106E-02, -2.503131E-01, 8.315270E-02, -1.228034E-02, 9.804036E-04, -4.413030E-05, 1.057734E-06, -1.052755E-08) :
+		       horner(mV, -1.318058E+02, 4.830222E+01, -1.646031E+00, 5.464731E-02, -9.650715E-04, 8.802193E-06, -3.110810E-08);
+	}
+	static constexpr double typeE(double mV) {
+		return mV < 0 ? horner(mV, 0, 1.6977288E+01, -4.3514970E-01, -1.5859697E-01, -9.2502871E-02, -2.6084314E-02, -4.1360199E-03, -3.4034030E-04, -1.1564890E-05) :
+		       horner(mV, 0, 1.7057035E+01, -2.3301759E-01, 6.5435585E-03, -7.3562749E-05, -1.7896001E-06, 8.4036165E-08, -1.3735879E-09, 1.0629823E-11, -3.2447087E-14);
+	}
+	static constexpr double typeN(double mV) {
+		return mV < 0 ? horner(mV, 0, 3.8436847E+01, 1.1010485E+00, 5.2229312E+00, 7.2060525E+00, 5.8488586E+00, 2.7754916E+00, 7.7075166E-01, 1.1582665E-01, 7.3138868E-03) :
+		       mV < 20.613 ? horner(mV, 0, 3.86896E+01, -1.08267E+00, 4.70205E-02, -2.12169E-06, -1.17272E-04, 5.39280E-06, -7.98156E-08) :
+		       horner(mV, 1.972485E+01, 3.300943E+01, -3.915159E-01, 9.855391E-03, -1.274371E-04, 7.767022E-07);
+	}
+	static constexpr double typeR(double mV) {
+		return mV < 1.923 ? horner(mV, 0, 1.8891380E+02, -9.3835290E+01, 1.3068619E+02, -2.2703580E+02, 3.5145659E+02, -3.8953900E+02, 2.8239471E+02, -1.2607281E+02, 3.1353611E+01, -3.3187769E+00) :
+		       mV < 11.361 ? horner(mV, 1.334584505E+01, 1.472644573E+02, -1.844024844E+01, 4.031129726E+00, -6.249428360E-01, 6.468412046E-02, -4.458750426E-03, 1.994710149E-04, -5.313401790E-06, 6.481976217E-08) :
+		       mV < 19.739 ? horner(mV, -8.199599416E+01, 1.553962042E+02, -8.342197663E+00, 4.279433549E-01, -1.191577910E-02, 1.492290091E-04) :
+		       horner(mV, 3.406177836E+04, -7.023729171E+03, 5.582903813E+02, -1.952394635E+01, 2.560740231E-01);
+	}
+	static constexpr double typeS(double mV) {
+		return mV < 1.874 ? horner(mV, 0, 1.84949460E+02, -8.00504062E+01, 1.02237430E+02, -1.52248592E+02, 1.88821343E+02, -1.59085941E+02, 8.23027880E+01, -2.34181944E+01, 2.79786260E+00) :
+		       mV < 10.332 ? horner(mV, 1.291507177E+01, 1.466298863E+02, -1.534713402E+01, 3.145945973E+00, -4.163257839E-01, 3.187963771E-02, -1.291637500E-03, 2.183475087E-05, -1.447379511E-07, 8.211272125E-09) :
+		       mV < 17.536 ? horner(mV, -8.087801117E+01, 1.621573104E+02, -8.536869453E+00, 4.719686976E-01, -1.441693666E-02, 2.081618890E-04) :
+		       horner(mV, 5.333875126E+04, -1.235892298E+04, 1.092657613E+03, -4.265693686E+01, 6.247205420E-01);
+	}
+	static constexpr double typeT(double mV) {
+		return mV < 0 ? horner(mV, 0, 2.5949192E+01, -2.1316967E-01, 7.9018692E-01, 4.2527777E-01, 1.3304473E-01, 2.0241446E-02, 1.2668171E-03) :
+		       horner(mV, 0, 2.592800E+01, -7.602961E-01, 4.637791E-02, -2.165394E-03, 6.048144E-05, -7.293422E-07);
+	}
+	static constexpr double typeB(double mV) {
+		return mV < 2.431 ? horner(mV, 9.8423321E+01, 6.9971500E+02, -8.4765304E+02, 1.0052644E+03, -8.3345952E+02, 4.5508542E+02, -1.5523037E+02, 2.9886750E+01, -2.4742860E+00) :
+		       horner(mV, 2.1315071E+02, 2.8510504E+02, -5.2742887E+01, 9.9160804E+00, -1.2965303E+00, 1.1195870E-01, -6.0625199E-03, 1.8661696E-04, -2.4878585E-06);
+	}
+	static constexpr double celsius(uint8_t type, double mV) {
+		return type == LTC298X_TYPE_TC_J ? typeJ(mV) : type == LTC298X_TYPE_TC_K ? typeK(mV) :
+		       type == LTC298X_TYPE_TC_E ? typeE(mV) : type == LTC298X_TYPE_TC_N ? typeN(mV) :
+		       type == LTC298X_TYPE_TC_R ? typeR(mV) : type == LTC298X_TYPE_TC_S ? typeS(mV) :
+		       type == LTC298X_TYPE_TC_T ? typeT(mV) : typeB(mV);
+	}
+	//valid mV range of the polynomials
+	static constexpr double low(uint8_t type) {
+		return type == LTC298X_TYPE_TC_J ? -8.095 : type == LTC298X_TYPE_TC_K ? -5.891 :
+		       type == LTC298X_TYPE_TC_E ? -8.825 : type == LTC298X_TYPE_TC_N ? -3.990 :
+		       type == LTC298X_TYPE_TC_R ? -0.226 : type == LTC298X_TYPE_TC_S ? -0.235 :
+		       type == LTC298X_TYPE_TC_T ? -5.603 : 0.291;
+	}
+	static constexpr double high(uint8_t type) {
+		return type == LTC298X_TYPE_TC_J ? 69.553 : type == LTC298X_TYPE_TC_K ? 54.886 :
+		       type == LTC298X_TYPE_TC_E ? 76.373 : type == LTC298X_TYPE_TC_N ? 47.513 :
+		       type == LTC298X_TYPE_TC_R ? 21.103 : type == LTC298X_TYPE_TC_S ? 18.693 :
+		       type == LTC298X_TYPE_TC_T ? 20.872 : 13.820;
+	}
+	//grid spacing for an interpolation error of about 0.05 °C, the accuracy of the polynomials
+	static constexpr uint8_t shift(uint8_t type) {
+		return type == LTC298X_TYPE_TC_N ? 7 : type >= LTC298X_TYPE_TC_R && type <= LTC298X_TYPE_TC_S ? 6 : type == LTC298X_TYPE_TC_B ? 6 : 8;
+	}
+};
+
+/*
+ * Curves, input in 2,21 fixed point as read from ADC channels
+ */
+template<uint8_t type, uint8_t grid_shift = LTC298XNist::shift(type)>
+struct LTC298XThermocoupleCurve {
+	static_assert(type >= LTC298X_TYPE_TC_J && type <= LTC298X_TYPE_TC_B, "not a thermocouple type");
+	static_assert(grid_shift >= 4 && grid_shift <= 16, "grid shift out of range");
+	static constexpr double scale = 2097.152; //2,21 counts per mV
+	static constexpr double low = LTC298XNist::low(type) * scale;
+	static constexpr double high = LTC298XNist::high(type) * scale;
+	static constexpr uint8_t shift = grid_shift;
+	static constexpr double celsius(double input) {
+		return LTC298XNist::celsius(type, input / scale);
+	}
+};
+
+/*
+ * R/R0 = 1 + A t + B t² + C (t - 100) t³, C only below 0 °C
+ */
+template<uint8_t curve>
+struct LTC298XCallendarVanDusen {
+	static_assert(curve <= RTD_CURVE_JAPANESE, "only Callendar-Van Dusen curves, ITS-90 is not supported");
+	static constexpr double a = curve == RTD_CURVE_EUROPEAN ? 3.9083e-3 : curve == RTD_CURVE_AMERICAN ? 3.9692e-3 : 3.9739e-3;
+	static constexpr double b = curve == RTD_CURVE_EUROPEAN ? -5.775e-7 : curve == RTD_CURVE_AMERICAN ? -5.8495e-7 : -5.870e-7;
+	static constexpr double c = curve == RTD_CURVE_EUROPEAN ? -4.183e-12 : curve == RTD_CURVE_AMERICAN ? -4.2325e-12 : -4.4e-12;
+	static constexpr double ratio(double t) {
+		return 1 + a * t + b * t * t + (t < 0 ? c * (t - 100) * t * t * t : 0);
+	}
+	static constexpr double slope(double t) {
+		return a + 2 * b * t + (t < 0 ? c * (4 * t - 300) * t * t : 0);
+	}
+	//Newton iterations from the linear estimate
+	static constexpr double celsius(double r, double t = 0, uint8_t steps = 8) {
+		return steps == 8 ? celsius(r, (r - 1) / a, 7) : steps ? celsius(r, t - (ratio(t) - r) / slope(t), steps - 1) : t;
+	}
+};
+
+template<uint8_t curve, uint8_t grid_shift = 15>
+struct LTC298XRTDCurve {
+	typedef LTC298XCallendarVanDusen<curve> CVD;
+	static_assert(grid_shift >= 8 && grid_shift <= 18, "grid shift out of range");
+	static constexpr double scale = 2097152; //2,21 counts per unit of R/R0
+	static constexpr double low = CVD::ratio(-200) * scale;
+	static constexpr double high = CVD::ratio(850) * scale;
+	static constexpr uint8_t shift = grid_shift;
+	static constexpr double celsius(double input) {
+		return CVD::celsius(input / scale);
+	}
+};
+
+/*
+ * Grid of a curve, the first point is the largest multiple of the spacing not above the curve
+ */
+template<typename Curve>
+struct LTC298XGrid {
+	static constexpr int32_t step = (int32_t)1 << Curve::shift;
+	static constexpr int32_t floorDiv(int32_t x, int32_t d) {
+		return x / d - (x % d < 0);
+	}
+	static constexpr int32_t floorInput(double x) {
+		return (int32_t)x - ((int32_t)x > x);
+	}
+	static constexpr int32_t base = floorDiv(floorInput(Curve::low), step) * step;
+	static constexpr uint16_t points = (floorInput(Curve::high) - base) / step + 2;
+	//ends of the curve relative to base, inputs are clamped to them
+	static constexpr int32_t first = floorInput(Curve::low) - base;
+	static constexpr int32_t last = floorInput(Curve::high) - base;
+	static constexpr int32_t roundValue(double celsius) {
+		return celsius < 0 ? -(int32_t)(0.5 - celsius * 1024) : (int32_t)(celsius * 1024 + 0.5);
+	}
+	static constexpr int32_t value(uint16_t i) {
+		return roundValue(Curve::celsius(base + (int32_t)i * step));
+	}
+	//checks over [first, last], split in halves to keep the recursion shallow
+	static constexpr int32_t larger(int32_t x, int32_t y) {
+		return x > y ? x : y;
+	}
+	static constexpr int32_t maxStep(uint16_t first, uint16_t last) {
+		return last - first == 1 ? value(last) - value(first) : larger(maxStep(first, (first + last) / 2), maxStep((first + last) / 2, last));
+	}
+	static constexpr bool increasing(uint16_t first, uint16_t last) {
+		return last - first == 1 ? value(last) > value(first) : increasing(first, (first + last) / 2) && increasing((first + last) / 2, last);
+	}
+	static_assert(points >= 2 && points <= 4096, "too many grid points, raise the shift");
+	static_assert(increasing(0, points - 1), "curve is not increasing on the grid");
+	static_assert((int64_t)maxStep(0, points - 1) * step < INT32_MAX, "interpolation overflows, lower the shift");
+};
+
+template<typename Grid, typename Indices>
+struct LTC298XGridValues;
+template<typename Grid, uint16_t... I>
+struct LTC298XGridValues<Grid, LTC298XIndices<I...> > {
+	static const int32_t values[sizeof...(I)];
+};
+template<typename Grid, uint16_t... I>
+const int32_t LTC298XGridValues<Grid, LTC298XIndices<I...> >::values[sizeof...(I)] PROGMEM = {
+	Grid::value(I)...
+};
+
+class LTC298XLinearizer {
+	private:
+		const int32_t* _values; //PROGMEM
+		int32_t _base;
+		int32_t _first;
+		int32_t _last;
+		uint8_t _shift;
+		uint16_t _points;
+		
+		LTC298XLinearizer(const int32_t* values, int32_t base, int32_t first, int32_t last, uint8_t shift, uint16_t points);
+		
+	public:
+		template<typename Curve>
+		static LTC298XLinearizer of(void) {
+			typedef LTC298XGrid<Curve> Grid;
+			return LTC298XLinearizer(LTC298XGridValues<Grid, typename LTC298XMakeIndices<Grid::points>::type>::values,
+			                         Grid::base, Grid::first, Grid::last, Curve::shift, Grid::points);
+		}
+		
+		int32_t convert(int32_t input) const;
+		void convert(const int32_t* input, int32_t* output, uint16_t count, int32_t offset = 0) const;
+		void apply(uint32_t mask, int32_t* raw, const uint8_t* status, int32_t offset = 0) const;
+		int32_t toInput(int32_t value) const;
+};
+
+#endif //LTC298XLINEARIZER_H
@@ -0,0 +1,45 @@
+#include "LTC298XReporter.h"
+
+/*
+ * Params:
+ * ch           | Channel (1-20)
+ * deadband     | Change in raw LSB (1/1024 ° for temperatures) the result must exceed, 0 reports every change
+ * heartbeat_ms | Longest time without a report, 0 for none
+ */
+bool LTC298XReporter::setDeadband(uint8_t ch, uint32_t deadband, uint32_t heartbeat_ms) {
+	if (ch > 20 || ch == 0) return false; //invalid
+	_deadband[ch - 1] = deadband;
+	_heartbeat[ch - 1] = heartbeat_ms;
+	return true;
+}
+/*
+ * Check the results of channels in mask (arrays indexed by ch - 1) at time now (millis()).
+ * Returns the channels to report, their values become the new reference.
+ */
+uint32_t LTC298XReporter::update(uint32_t mask, const int32_t* raw, const uint8_t* status, uint32_t now) {
+	uint32_t report = 0;
+	for (uint8_t i = 0; i < 20; i++) {
+		uint32_t bit = (uint32_t)1 << i;
+		if (!(mask & bit)) continue;
+		if (_reported & bit) {
+			//difference as unsigned, so results far apart do not overflow
+			uint32_t delta = raw[i] > _last[i] ? (uint32_t)raw[i] - (uint32_t)_last[i] : (uint32_t)_last[i] - (uint32_t)raw[i];
+			if (delta <= _deadband[i] &&
+			    status[i] == _status[i] &&
+			    (!_heartbeat[i] || now - _time[i] < _heartbeat[i])
+			) continue; //nothing to report
+		}
+		report |= bit;
+		_last[i] = raw[i];
+		_status[i] = status[i];
+		_time[i] = now;
+	}
+	_reported |= report;
+	return report;
+}
+/*
+ * Report every channel on its next result
+ */
+void LTC298XReporter::reset(void) {
+	_reported = 0;
+}
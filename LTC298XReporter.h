@@ -0,0 +1,35 @@
+#ifndef LTC298XREPORTER_H
+#define LTC298XREPORTER_H
+#include <Arduino.h>
+
+/****************************************************
+
+Change-only reporting for the LTC298X library.
+A result is passed on when it moved more than the
+deadband of its channel since the last reported value,
+when its status byte changed or when the channel was
+silent for its heartbeat interval. Works on the raw
+24 bit results, no floating point.
+
+LTC298XReporter reporter;
+reporter.setDeadband(4, 102, 60000); //0.1 °, at least once a minute
+sensor.setReporter(&reporter);
+
+*****************************************************/
+
+class LTC298XReporter {
+	private:
+		uint32_t _deadband[20] = {0};
+		uint32_t _heartbeat[20] = {0};
+		int32_t _last[20];
+		uint8_t _status[20];
+		uint32_t _time[20];
+		uint32_t _reported = 0; //channels with a last reported value
+		
+	public:
+		bool setDeadband(uint8_t ch, uint32_t deadband, uint32_t heartbeat_ms);
+		uint32_t update(uint32_t mask, const int32_t* raw, const uint8_t* status, uint32_t now);
+		void reset(void);
+};
+
+#endif //LTC298XREPORTER_H
@@ -0,0 +1,96 @@
+#include "LTC298XRing.h"
+#ifdef __AVR__
+#include <util/atomic.h>
+#endif
+
+/*
+ * Index access shared by producer and consumer. AVR has no lock-free 16 bit atomics,
+ * interrupts are blocked for the two byte access instead, which also orders it like a barrier.
+ */
+#ifdef __AVR__
+static inline uint16_t loadIndex(const volatile uint16_t* index) {
+	uint16_t value;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		value = *index;
+	}
+	return value;
+}
+static inline void storeIndex(volatile uint16_t* index, uint16_t value) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*index = value;
+	}
+}
+#else
+static inline uint16_t loadIndex(const uint16_t* index) {
+	return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+static inline void storeIndex(uint16_t* index, uint16_t value) {
+	__atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+#endif
+
+/*
+ * Use buf with capacity entries, only the largest power of two not above capacity is used.
+ * Indices run freely and are masked on access, so all entries can be filled.
+ * A capacity of 0 behaves like buf == NULL, every sample is dropped.
+ */
+LTC298XRing::LTC298XRing(LTC298XSample* buf, uint16_t capacity) : _buf(capacity ? buf : NULL) {
+	uint16_t size = 1;
+	while (size <= capacity / 2) size <<= 1;
+	_mask = size - 1;
+}
+
+/*
+ * Append a sample, returns false and counts it as dropped if the queue is full.
+ * The consumer is never blocked, a stalled consumer only loses the newest samples.
+ */
+bool LTC298XRing::push(const LTC298XSample& sample) {
+	uint16_t head = _head;
+	uint16_t tail = loadIndex(&_tail);
+	if (!_buf || (uint16_t)(head - tail) > _mask) {
+		_dropped++;
+		return false;
+	}
+	_buf[head & _mask] = sample;
+	storeIndex(&_head, head + 1); //publish after the entry is written
+	return true;
+}
+/*
+ * Samples lost since the queue was created, wraps at 65536
+ */
+uint16_t LTC298XRing::dropped(void) {
+	return loadIndex(&_dropped);
+}
+
+uint16_t LTC298XRing::available(void) {
+	return loadIndex(&_head) - _tail;
+}
+/*
+ * Copy up to max samples to out, returns the number copied
+ */
+uint16_t LTC298XRing::pop(LTC298XSample* out, uint16_t max) {
+	uint16_t tail = _tail;
+	uint16_t count = loadIndex(&_head) - tail;
+	if (count > max) count = max;
+	for (uint16_t i = 0; i < count; i++) out[i] = _buf[(tail + i) & _mask];
+	storeIndex(&_tail, tail + count); //free the entries after reading them
+	return count;
+}
+/*
+ * Zero-copy batch access: first points to the oldest sample, returns the number of samples
+ * stored contiguously from there. Release them with consume() when done.
+ */
+uint16_t LTC298XRing::peek(const LTC298XSample** first) {
+	uint16_t tail = _tail;
+	uint16_t count = loadIndex(&_head) - tail;
+	uint16_t to_end = _mask + 1 - (tail & _mask);
+	*first = _buf + (tail & _mask);
+	return count < to_end ? count : to_end;
+}
+void LTC298XRing::consume(uint16_t count) {
+	storeIndex(&_tail, _tail + count);
+}
+
+uint16_t LTC298XRing::capacity(void) {
+	return _buf ? _mask + 1 : 0;
+}
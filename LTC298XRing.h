@@ -0,0 +1,47 @@
+#ifndef LTC298XRING_H
+#define LTC298XRING_H
+#include <Arduino.h>
+
+/****************************************************
+
+Single-producer/single-consumer sample queue for the
+LTC298X library. The producer (LTC298X::poll(), e.g.
+from a timer) and the consumer (loop()) need no lock,
+the storage is provided by the caller.
+
+LTC298XSample samples[32];
+LTC298XRing ring(samples, 32);
+sensor.setSampleRing(&ring);
+
+*****************************************************/
+
+struct LTC298XSample {
+	uint32_t time;  //millis() when the result was read
+	int32_t raw;    //24 bit result, see LTC298X::readRaw()
+	uint8_t ch;     //1-20
+	uint8_t status; //fault/valid flags
+};
+
+class LTC298XRing {
+	private:
+		LTC298XSample* _buf;
+		uint16_t _mask;
+		uint16_t _head = 0; //written by the producer only
+		uint16_t _tail = 0; //written by the consumer only
+		uint16_t _dropped = 0;
+		
+	public:
+		LTC298XRing(LTC298XSample* buf, uint16_t capacity);
+		
+		//producer
+		bool push(const LTC298XSample& sample);
+		uint16_t dropped(void);
+		//consumer
+		uint16_t available(void);
+		uint16_t pop(LTC298XSample* out, uint16_t max);
+		uint16_t peek(const LTC298XSample** first);
+		void consume(uint16_t count);
+		uint16_t capacity(void);
+};
+
+#endif //LTC298XRING_H
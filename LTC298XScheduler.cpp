@@ -0,0 +1,60 @@
+#include "LTC298XScheduler.h"
+
+LTC298XScheduler::LTC298XScheduler(LTC298XDevice& device) : _device(device) {}
+
+/*
+ * Set the sample period of a channel.
+ * Params:
+ * ch        | Channel (1-20) to sample, must be set up on the device
+ * period_ms | Time between two samples in ms, 0 removes the channel from the schedule
+ * The first sample is taken on the next update().
+ */
+bool LTC298XScheduler::setPeriod(uint8_t ch, uint32_t period_ms) {
+	if (ch > 20 || ch == 0) return false; //invalid
+	uint32_t bit = (uint32_t)1 << (ch - 1);
+	if (!period_ms) {
+		_enabled &= ~bit;
+		return true;
+	}
+	_period[ch - 1] = period_ms;
+	_next[ch - 1] = millis();
+	_enabled |= bit;
+	return true;
+}
+/*
+ * Results are handed to the callback, mask contains all channels of the finished scan.
+ */
+void LTC298XScheduler::onSamples(LTC298XCallback callback) {
+	_callback = callback;
+}
+/*
+ * Call frequently from loop(). Collects finished scans and immediately starts the next one
+ * with all channels that are due at that time.
+ */
+void LTC298XScheduler::update(void) {
+	if (_running) {
+		int32_t raw[20];
+		uint8_t status[20];
+		if (!_device.poll(raw, status)) return; //still converting
+		_running = false;
+		if (_callback) _callback(_scan_mask, raw, status);
+	}
+	uint32_t now = millis();
+	uint32_t due = 0;
+	for (uint8_t i = 0; i < 20; i++) {
+		uint32_t bit = (uint32_t)1 << i;
+		if (!(_enabled & bit) || (int32_t)(now - _next[i]) < 0) continue;
+		due |= bit;
+		_next[i] += _period[i];
+		if ((int32_t)(now - _next[i]) >= 0) _next[i] = now + _period[i]; //fell behind, don't try to catch up
+	}
+	if (!due || !_device.startScan(due)) return;
+	_scan_mask = due;
+	_running = true;
+}
+/*
+ * Returns true while a scheduled scan is converting
+ */
+bool LTC298XScheduler::isRunning(void) {
+	return _running;
+}
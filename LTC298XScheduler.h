@@ -0,0 +1,33 @@
+#ifndef LTC298XSCHEDULER_H
+#define LTC298XSCHEDULER_H
+#include "LTC298X.h"
+
+/****************************************************
+
+Multi-rate scan scheduler for the LTC298X library.
+Every channel gets its own sample period, all channels
+due at the same time are converted in one scan and the
+next scan is started as soon as the results are read.
+
+*****************************************************/
+
+class LTC298XScheduler {
+	private:
+		LTC298XDevice& _device;
+		uint32_t _period[20];
+		uint32_t _next[20];
+		uint32_t _enabled = 0;
+		uint32_t _scan_mask = 0;
+		bool _running = false;
+		LTC298XCallback _callback = NULL;
+		
+	public:
+		LTC298XScheduler(LTC298XDevice& device);
+		
+		bool setPeriod(uint8_t ch, uint32_t period_ms);
+		void onSamples(LTC298XCallback callback);
+		void update(void);
+		bool isRunning(void);
+};
+
+#endif //LTC298XSCHEDULER_H
@@ -0,0 +1,79 @@
+#include "LTC298XTransport.h"
+
+LTC298XSPIBus::LTC298XSPIBus(void) :
+	_spi(SPI), _settings(LTC298X_SPI_CLOCK, MSBFIRST, SPI_MODE0) {}
+LTC298XSPIBus::LTC298XSPIBus(uint32_t clock) :
+	_spi(SPI), _settings(clock, MSBFIRST, SPI_MODE0) {}
+LTC298XSPIBus::LTC298XSPIBus(uint32_t clock, SPIClass& spi) :
+	_spi(spi), _settings(clock, MSBFIRST, SPI_MODE0) {}
+
+/*
+ * Set SCK frequency, the LTC298X accepts up to 2 MHz.
+ */
+void LTC298XSPIBus::setClock(uint32_t clock) {
+	_settings = SPISettings(clock, MSBFIRST, SPI_MODE0);
+}
+void LTC298XSPIBus::begin(void) {
+	_spi.begin();
+}
+/*
+ * Keep the SPI transaction open across accesses to several chips. Calls may be nested.
+ */
+void LTC298XSPIBus::hold(void) {
+	_hold++;
+}
+void LTC298XSPIBus::release(void) {
+	if (!_hold || --_hold) return;
+	if (!_active) return;
+	_spi.endTransaction();
+	_active = false;
+}
+void LTC298XSPIBus::beginTransaction(void) {
+	if (_active) return;
+	_spi.beginTransaction(_settings);
+	_active = true;
+}
+void LTC298XSPIBus::endTransaction(void) {
+	if (_hold) return; //ended by release()
+	_spi.endTransaction();
+	_active = false;
+}
+uint8_t LTC298XSPIBus::transfer(uint8_t data) {
+	return _spi.transfer(data);
+}
+
+LTC298XSPITransport::LTC298XSPITransport(uint8_t cs) :
+	_own(), _bus(&_own), _cs(cs) {}
+LTC298XSPITransport::LTC298XSPITransport(uint8_t cs, uint32_t clock) :
+	_own(clock), _bus(&_own), _cs(cs) {}
+LTC298XSPITransport::LTC298XSPITransport(uint8_t cs, uint32_t clock, SPIClass& spi) :
+	_own(clock, spi), _bus(&_own), _cs(cs) {}
+/*
+ * Share SPI peripheral and settings with other chips on the same bus.
+ */
+LTC298XSPITransport::LTC298XSPITransport(uint8_t cs, LTC298XSPIBus& bus) :
+	_own(), _bus(&bus), _cs(cs) {}
+
+void LTC298XSPITransport::setClock(uint32_t clock) {
+	_bus->setClock(clock);
+}
+
+void LTC298XSPITransport::begin(void) {
+	digitalWrite(_cs, HIGH);
+	pinMode(_cs, OUTPUT);
+	_bus->begin();
+}
+void LTC298XSPITransport::beginTransaction(void) {
+	_bus->beginTransaction();
+	digitalWrite(_cs, LOW);
+}
+void LTC298XSPITransport::endTransaction(void) {
+	digitalWrite(_cs, HIGH);
+	_bus->endTransaction();
+}
+void LTC298XSPITransport::transfer(const uint8_t* tx, uint8_t* rx, uint16_t len) {
+	for (uint16_t i = 0; i < len; i++) {
+		uint8_t val = _bus->transfer(tx ? tx[i] : 0);
+		if (rx) rx[i] = val;
+	}
+}
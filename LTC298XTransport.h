@@ -0,0 +1,73 @@
+#ifndef LTC298XTRANSPORT_H
+#define LTC298XTRANSPORT_H
+#include <SPI.h>
+
+/****************************************************
+
+Bus access for the LTC298X library.
+Implement LTC298XTransport to run the driver over another
+SPI peripheral, DMA or a different chip select strategy.
+
+*****************************************************/
+
+#define LTC298X_SPI_CLOCK        2000000
+#define LTC298X_NO_CS            0xFF
+
+class LTC298XTransport {
+	public:
+		virtual ~LTC298XTransport(void) {}
+		virtual void begin(void) = 0;
+		//Assert CS, everything transferred until endTransaction() is one auto-increment access
+		virtual void beginTransaction(void) = 0;
+		virtual void endTransaction(void) = 0;
+		//Full duplex transfer, tx == NULL sends zeros, rx == NULL discards the received bytes
+		virtual void transfer(const uint8_t* tx, uint8_t* rx, uint16_t len) = 0;
+};
+
+/*
+ * SPI peripheral and settings, may be shared by several chips.
+ * While held, SPI.beginTransaction() is only called once for all accesses until release().
+ */
+class LTC298XSPIBus {
+	private:
+		SPIClass& _spi;
+		SPISettings _settings;
+		uint8_t _hold = 0;
+		bool _active = false;
+		
+	public:
+		LTC298XSPIBus(void);
+		LTC298XSPIBus(uint32_t clock);
+		LTC298XSPIBus(uint32_t clock, SPIClass& spi);
+		void setClock(uint32_t clock);
+		void begin(void);
+		void hold(void);
+		void release(void);
+		void beginTransaction(void);
+		void endTransaction(void);
+		uint8_t transfer(uint8_t data);
+};
+
+/*
+ * Arduino SPI with a GPIO chip select. Override beginTransaction/endTransaction for faster CS handling.
+ */
+class LTC298XSPITransport : public LTC298XTransport {
+	protected:
+		LTC298XSPIBus _own;
+		LTC298XSPIBus* _bus;
+		uint8_t _cs;
+		
+	public:
+		LTC298XSPITransport(uint8_t cs);
+		LTC298XSPITransport(uint8_t cs, uint32_t clock);
+		LTC298XSPITransport(uint8_t cs, uint32_t clock, SPIClass& spi);
+		LTC298XSPITransport(uint8_t cs, LTC298XSPIBus& bus);
+		void setClock(uint32_t clock);
+		
+		virtual void begin(void);
+		virtual void beginTransaction(void);
+		virtual void endTransaction(void);
+		virtual void transfer(const uint8_t* tx, uint8_t* rx, uint16_t len);
+};
+
+#endif //LTC298XTRANSPORT_H
@@ -0,0 +1,138 @@
+#include "LTC298XTuner.h"
+
+//MUX delays tried, in 10 µs
+static const uint8_t mux_delays[] = {0, 5, 10, 20, 50, 100, 200, 255};
+#define MUX_DELAYS (sizeof(mux_delays) / sizeof(mux_delays[0]))
+static const uint8_t rejections[] = {LTC298X_REJECT_60HZ, LTC298X_REJECT_50HZ, LTC298X_REJECT_6050HZ};
+
+static uint32_t isqrt(uint64_t x) {
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+	while (bit > x) bit >>= 2;
+	while (bit) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+LTC298XTuner::LTC298XTuner(LTC298XDevice& device) : _device(device) {}
+
+/*
+ * Conversions per candidate setting (at least 2), more samples give a better estimate but take longer
+ */
+void LTC298XTuner::setSamples(uint8_t samples) {
+	_samples = samples < 2 ? 2 : samples;
+}
+
+void LTC298XTuner::setup(uint8_t reject, uint8_t mux_delay) {
+	if (reject == LTC298X_REJECT_60HZ) _device.reject60Hz();
+	else if (reject == LTC298X_REJECT_50HZ) _device.reject50Hz();
+	else _device.reject6050Hz();
+	_device.setMuxDelay(mux_delay);
+}
+/*
+ * Convert the channels _samples times. Without a reference, mean receives the average of every channel.
+ * Otherwise noise receives the worst RMS deviation from reference, including noise and settling error.
+ * Returns false if a conversion times out or a result is not valid.
+ */
+bool LTC298XTuner::measure(uint32_t channels, const int32_t* reference, int32_t* mean, uint32_t* noise) {
+	int64_t sum[20] = {0};
+	uint64_t square[20] = {0};
+	uint32_t timeout_ms = _device.estimateConversionTime(channels) / 500 + 100; //twice the prediction
+	for (uint8_t n = 0; n < _samples; n++) {
+		int32_t raw[20];
+		uint8_t status[20];
+		_device.beginMultipleConversion();
+		if (!_device.waitUntilDone(timeout_ms)) return false;
+		if (!_device.readResults(channels, raw, status)) return false;
+		for (uint8_t i = 0; i < 20; i++) {
+			if (!(channels & ((uint32_t)1 << i))) continue;
+			if (!(status[i] & 0x01)) return false; //not valid
+			sum[i] += raw[i];
+			if (reference) {
+				int64_t error = (int64_t)raw[i] - reference[i];
+				square[i] += (uint64_t)(error * error);
+			}
+		}
+	}
+	if (noise) *noise = 0;
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(channels & ((uint32_t)1 << i))) continue;
+		if (mean) mean[i] = sum[i] / _samples;
+		if (noise) {
+			uint32_t rms = isqrt(square[i] / _samples);
+			if (rms > *noise) *noise = rms;
+		}
+	}
+	return true;
+}
+
+/*
+ * Find the fastest MUX delay and rejection mode that keeps every channel within noise_budget.
+ * Params:
+ * channels     | Channels (same format as selectConversionChannels) to tune for, all must be set up
+ * noise_budget | Allowed RMS error against the reference in raw LSB (1/1024 ° for temperatures)
+ * result       | Receives the chosen setting, which is also applied to the device
+ * Candidates are tried in order of their predicted scan time, so the first one within budget is the fastest.
+ * Returns false if none meets the budget, the reference setting (50/60 Hz, longest MUX delay) is applied then.
+ * If the reference can't be measured, result->noise is 0xFFFFFFFF.
+ */
+bool LTC298XTuner::tune(uint32_t channels, uint32_t noise_budget, LTC298XTuning* result) {
+	if (!channels || !_device.selectConversionChannels(channels)) return false; //invalid
+	int32_t reference[20];
+	this->setup(LTC298X_REJECT_6050HZ, mux_delays[MUX_DELAYS - 1]);
+	result->version = LTC298X_TUNING_VERSION;
+	result->reject = LTC298X_REJECT_6050HZ;
+	result->mux_delay = mux_delays[MUX_DELAYS - 1];
+	result->conversion_us = _device.estimateConversionTime(channels);
+	result->noise = 0xFFFFFFFF; //unknown until the reference is measured
+	uint32_t noise;
+	if (!this->measure(channels, NULL, reference, NULL) ||
+	    !this->measure(channels, reference, NULL, &noise)
+	) return false;
+	result->noise = noise;
+	uint32_t tried[sizeof(rejections)] = {0}; //bit per MUX delay
+	while (true) {
+		//untried candidate with the shortest predicted time
+		uint8_t best_r = 0;
+		uint8_t best_m = 0xFF;
+		uint32_t best_us = 0;
+		for (uint8_t r = 0; r < sizeof(rejections); r++) {
+			for (uint8_t m = 0; m < MUX_DELAYS; m++) {
+				if (tried[r] & ((uint32_t)1 << m)) continue;
+				uint32_t us = _device.estimateConversionTime(channels, rejections[r], mux_delays[m]);
+				if (best_m != 0xFF && us >= best_us) continue;
+				best_r = r;
+				best_m = m;
+				best_us = us;
+			}
+		}
+		if (best_m == 0xFF || best_us >= result->conversion_us) break; //not faster than the reference
+		tried[best_r] |= (uint32_t)1 << best_m;
+		this->setup(rejections[best_r], mux_delays[best_m]);
+		if (!this->measure(channels, reference, NULL, &noise) || noise > noise_budget) continue;
+		result->reject = rejections[best_r];
+		result->mux_delay = mux_delays[best_m];
+		result->noise = noise;
+		result->conversion_us = best_us;
+		return true;
+	}
+	this->setup(result->reject, result->mux_delay);
+	return result->noise <= noise_budget;
+}
+
+/*
+ * Apply a stored result, returns false if it was saved by an incompatible version
+ */
+bool LTC298XTuner::apply(LTC298XDevice& device, const LTC298XTuning& tuning) {
+	if (tuning.version != LTC298X_TUNING_VERSION) return false;
+	LTC298XTuner tuner(device);
+	tuner.setup(tuning.reject, tuning.mux_delay);
+	return true;
+}
@@ -0,0 +1,46 @@
+#ifndef LTC298XTUNER_H
+#define LTC298XTUNER_H
+#include "LTC298X.h"
+
+/****************************************************
+
+Calibration of MUX delay and mains rejection for the
+sensors installed on an LTC298X. Every candidate
+setting is measured through the normal conversion path
+against a reference taken with the most conservative
+setting, the fastest one within the noise budget wins.
+Store the result (e.g. in EEPROM) and apply() it on the
+next start instead of tuning again.
+
+LTC298XTuner tuner(sensor);
+LTC298XTuning tuning;
+if (tuner.tune(LTC298X_CH4 | LTC298X_CH6, 20, &tuning)) save(tuning);
+
+*****************************************************/
+
+#define LTC298X_TUNING_VERSION   1
+#define LTC298X_TUNER_SAMPLES    8 //conversions per candidate setting
+
+struct LTC298XTuning {
+	uint8_t version;        //LTC298X_TUNING_VERSION
+	uint8_t reject;         //LTC298X_REJECT_*
+	uint8_t mux_delay;      //as for setMuxDelay()
+	uint32_t noise;         //worst channel RMS error against the reference in raw LSB
+	uint32_t conversion_us; //predicted time of a scan of the tuned channels
+};
+
+class LTC298XTuner {
+	private:
+		LTC298XDevice& _device;
+		uint8_t _samples = LTC298X_TUNER_SAMPLES;
+		void setup(uint8_t reject, uint8_t mux_delay);
+		bool measure(uint32_t channels, const int32_t* reference, int32_t* mean, uint32_t* noise);
+		
+	public:
+		LTC298XTuner(LTC298XDevice& device);
+		void setSamples(uint8_t samples);
+		bool tune(uint32_t channels, uint32_t noise_budget, LTC298XTuning* result);
+		static bool apply(LTC298XDevice& device, const LTC298XTuning& tuning);
+};
+
+#endif //LTC298XTUNER_H
@@ -0,0 +1,229 @@
+/****************************************************
+
+Bus cost benchmark for the LTC298X library.
+Runs every public operation and typical scan workloads
+against the simulated chip of extras/host and reports
+SPI transactions, bytes and estimated time per call.
+
+g++ -std=c++11 -I. -Iextras/host extras/bench/LTC298XBench.cpp *.cpp extras/host/HostBoard.cpp extras/host/LTC298XSim.cpp -o ltc298x_bench
+./ltc298x_bench [--clock HZ] [--cs-overhead-us US] [--csv]
+
+*****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LTC298X.h"
+#include "LTC298XConfig.h"
+#include "LTC298XSim.h"
+#include "LTC298XTuner.h"
+
+#define BENCH_CS                 10
+#define BENCH_IRQ                2
+
+static uint32_t clock_hz = LTC298X_SPI_CLOCK;
+static double cs_overhead_us = 2.0; //CS toggling and SPI.beginTransaction per transaction
+static bool csv = false;
+static bool first_row = true;
+
+static HostBusStats start_stats;
+static uint64_t start_ns;
+
+static void begin(void) {
+	start_stats = hostBusStats();
+	start_ns = hostNanos();
+}
+static void report(const char* op, uint32_t calls) {
+	HostBusStats stats = hostBusStats();
+	uint32_t transactions = stats.transactions - start_stats.transactions;
+	uint32_t bytes = stats.bytes - start_stats.bytes;
+	double bus_us = (stats.busy_ns - start_stats.busy_ns) / 1000.0;
+	double est_us = bytes * 8e6 / clock_hz + transactions * cs_overhead_us;
+	double elapsed_us = (hostNanos() - start_ns) / 1000.0;
+	if (csv) {
+		printf("%s,%u,%.2f,%.2f,%.2f,%.2f,%.2f\n", op, calls,
+			(double)transactions / calls, (double)bytes / calls, bus_us / calls, est_us / calls, elapsed_us / calls);
+	} else {
+		printf("%s\n  {\"op\": \"%s\", \"calls\": %u, \"transactions\": %.2f, \"bytes\": %.2f, \"bus_us\": %.2f, \"est_us\": %.2f, \"elapsed_us\": %.2f}",
+			first_row ? "" : ",", op, calls,
+			(double)transactions / calls, (double)bytes / calls, bus_us / calls, est_us / calls, elapsed_us / calls);
+	}
+	first_row = false;
+}
+
+/*
+ * Channel layout of a fully populated chip used by the workloads
+ */
+static void setupAll(LTC298XDevice& dev) {
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupSenseResistor(3, 2000);
+	for (uint8_t ch = 4; ch <= 12; ch++) dev.setupThermocouple(ch, LTC298X_TYPE_TC_K, 1, true);
+	dev.setupRTD(14, LTC298X_TYPE_PT_100, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, RTD_CURVE_EUROPEAN);
+	dev.setupRTD(16, LTC298X_TYPE_PT_100, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, RTD_CURVE_EUROPEAN);
+	for (uint8_t ch = 17; ch <= 20; ch++) dev.setupThermistor(ch, LTC298X_TYPE_THER_44006, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO);
+}
+/*
+ * Same layout as a PROGMEM image and a custom table for loadConfig() and loadTable()
+ */
+template<uint8_t ch> using BenchTC = LTC298XThermocouple<ch, LTC298X_TYPE_TC_K, 1, true>;
+template<uint8_t ch> using BenchRTD = LTC298XRTD<ch, LTC298X_TYPE_PT_100, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, RTD_CURVE_EUROPEAN>;
+template<uint8_t ch> using BenchTherm = LTC298XThermistor<ch, LTC298X_TYPE_THER_44006, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO>;
+typedef LTC298XConfigImage<
+	LTC298XDiode<1, true, false, false, DIODE_CURRENT_10uA>, LTC298XSenseResistor<3, LTC298X_OHM(2000)>,
+	BenchTC<4>, BenchTC<5>, BenchTC<6>, BenchTC<7>, BenchTC<8>, BenchTC<9>, BenchTC<10>, BenchTC<11>, BenchTC<12>,
+	BenchRTD<14>, BenchRTD<16>, BenchTherm<17>, BenchTherm<18>, BenchTherm<19>, BenchTherm<20>
+> BenchConfig;
+static const uint8_t bench_table[] PROGMEM = {
+	LTC298X_ROW_RTD(100, 250), LTC298X_ROW_RTD(110, 260), LTC298X_ROW_RTD(120, 270), LTC298X_ROW_RTD(130, 280),
+	LTC298X_ROW_RTD(140, 290), LTC298X_ROW_RTD(150, 300), LTC298X_ROW_RTD(160, 310), LTC298X_ROW_RTD(170, 320),
+	LTC298X_ROW_RTD(180, 330), LTC298X_ROW_RTD(190, 340)
+};
+static void fillTable(double* x, double* kelvin, uint8_t n, double x0, double dx) {
+	for (uint8_t i = 0; i < n; i++) {
+		x[i] = x0 + i * dx;
+		kelvin[i] = 100 + i * 10;
+	}
+}
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--clock") && i + 1 < argc) clock_hz = strtoul(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "--cs-overhead-us") && i + 1 < argc) cs_overhead_us = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--csv")) csv = true;
+		else {
+			fprintf(stderr, "usage: %s [--clock HZ] [--cs-overhead-us US] [--csv]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (!clock_hz) clock_hz = LTC298X_SPI_CLOCK;
+	
+	LTC298XSim chip(BENCH_CS, BENCH_IRQ);
+	LTC298XSPITransport bus(BENCH_CS, clock_hz);
+	LTC298XDevice dev(bus);
+	LTC298XDevice dev_irq(bus, BENCH_IRQ);
+	dev.begin();
+	dev_irq.begin();
+	for (uint8_t ch = 1; ch <= 20; ch++) chip.setValue(ch, 25 * 1024 + ch);
+	
+	if (csv) printf("op,calls,transactions,bytes,bus_us,est_us,elapsed_us\n");
+	else printf("{\"clock_hz\": %u, \"cs_overhead_us\": %.2f, \"results\": [", clock_hz, cs_overhead_us);
+	
+	//global configuration, first call after invalidateCache() and repeated calls
+	dev.invalidateCache();
+	begin(); dev.reportFahrenheit(); report("reportFahrenheit/cold", 1);
+	begin(); dev.reportCelsius(); report("reportCelsius", 1);
+	begin(); dev.reportCelsius(); report("reportCelsius/unchanged", 1);
+	begin(); dev.reject50Hz(); report("reject50Hz", 1);
+	begin(); dev.reject60Hz(); report("reject60Hz", 1);
+	begin(); dev.reject6050Hz(); report("reject6050Hz", 1);
+	begin(); dev.reject6050Hz(); report("reject6050Hz/unchanged", 1);
+	begin(); dev.setMuxDelay(100); report("setMuxDelay", 1);
+	begin(); dev.setMuxDelay(100); report("setMuxDelay/unchanged", 1);
+	begin(); dev.selectConversionChannels(0xFFFFF); report("selectConversionChannels", 1);
+	begin(); dev.selectConversionChannels(0xFFFFF); report("selectConversionChannels/unchanged", 1);
+	begin(); dev.resync(); report("resync", 1);
+	
+	//channel assignments
+	begin(); dev.setupDiode(1, true, true, false, DIODE_CURRENT_20uA); report("setupDiode", 1);
+	begin(); dev.setupSenseResistor(3, 1000); report("setupSenseResistor", 1);
+	begin(); dev.setupThermocouple(4, LTC298X_TYPE_TC_J, 1, true); report("setupThermocouple", 1);
+	begin(); dev.setupRTD(14, LTC298X_TYPE_PT_1000, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_50uA, RTD_CURVE_EUROPEAN); report("setupRTD", 1);
+	begin(); dev.setupThermistor(17, LTC298X_TYPE_THER_44004, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO); report("setupThermistor", 1);
+	begin(); dev.setupADC(5, true); report("setupADC", 1);
+	begin(); dev.setupADC(5, true); report("setupADC/unchanged", 1);
+	begin(); dev.disableChannel(5); report("disableChannel", 1);
+	
+	//custom tables
+	double x[60];
+	double kelvin[60];
+	float coeff[6] = {1.1e-3, 2.3e-4, 0, 9e-8, 0, 0};
+	fillTable(x, kelvin, 3, 0.5, 0.5);
+	begin(); dev.setupCustomThermocouple(6, 1, true, false, TC_CURRENT_10uA, x, kelvin, 3); report("setupCustomThermocouple/3", 1);
+	fillTable(x, kelvin, 60, 10, 5);
+	begin(); dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 60); report("setupCustomRTD/60", 1);
+	kelvin[30] += 0.5;
+	begin(); dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 60); report("setupCustomRTD/60/one_changed", 1);
+	fillTable(x, kelvin, 60, 100, 500);
+	dev.disableChannel(8); //free its table
+	begin(); dev.setupCustomThermistor(18, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO, x, kelvin, 60); report("setupCustomThermistor/60", 1);
+	dev.disableChannel(18);
+	begin(); dev.setupSteinhartHartThermistor(19, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO, coeff); report("setupSteinhartHartThermistor", 1);
+	
+	//bring-up of a fully populated chip
+	for (uint8_t ch = 1; ch <= 20; ch++) dev.disableChannel(ch);
+	begin(); setupAll(dev); report("setupAll/immediate", 1);
+	for (uint8_t ch = 1; ch <= 20; ch++) dev.disableChannel(ch);
+	begin(); dev.beginConfig(); setupAll(dev); dev.commitConfig(); report("setupAll/staged", 1);
+	for (uint8_t ch = 1; ch <= 20; ch++) dev.disableChannel(ch);
+	begin(); dev.loadConfig(BenchConfig::words); report("setupAll/loadConfig", 1);
+	begin(); dev.loadTable(40, bench_table, sizeof(bench_table)); report("loadTable/10", 1);
+	begin(); dev.loadTable(40, bench_table, sizeof(bench_table)); report("loadTable/10/unchanged", 1);
+	
+	//configuration image with a custom table in use
+	uint8_t image[LTC298X_IMAGE_MAX];
+	fillTable(x, kelvin, 20, 10, 5);
+	dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 20);
+	begin(); uint16_t image_len = dev.saveImage(image, sizeof(image)); report("saveImage", 1);
+	begin(); dev.restoreImage(image, image_len); report("restoreImage", 1);
+	
+	//readout
+	const uint32_t all = 0xFFFFF;
+	int32_t raw[20];
+	uint8_t status[20];
+	dev.selectConversionChannels(all);
+	dev.invalidateCache();
+	begin(); dev.beginMultipleConversion(); report("beginMultipleConversion/cold", 1);
+	delay(10000);
+	dev.invalidateCache();
+	begin(); dev.estimateConversionTime(0); report("estimateConversionTime/cold", 1);
+	begin(); dev.estimateConversionTime(0); report("estimateConversionTime", 1);
+	begin(); dev.isDone(); report("isDone", 1);
+	begin(); dev.readTemperature(4); report("readTemperature", 1);
+	begin(); dev.readADC(4); report("readADC", 1);
+	begin(); dev.readRaw(4, status); report("readRaw", 1);
+	begin(); dev.readTemperatureMilli(4, status); report("readTemperatureMilli", 1);
+	begin(); for (uint8_t ch = 1; ch <= 20; ch++) dev.readTemperature(ch); report("read20/readTemperature", 1);
+	begin(); dev.readResults(all, raw, status); report("read20/readResults", 1);
+	begin(); dev.readResults(LTC298X_CH4 | LTC298X_CH5, raw, status); report("read2/readResults", 1);
+	begin(); dev.readResults(LTC298X_CH1 | LTC298X_CH20, raw, status); report("read2/readResults/span", 1); //reads the whole span
+	begin(); dev.readResults(0, raw, status); report("read20/readResults/selected", 1);
+	
+	//complete scans of all channels, conversion time included in elapsed_us
+	const uint8_t scans = 10;
+	begin();
+	for (uint8_t i = 0; i < scans; i++) {
+		dev.beginMultipleConversion();
+		while (!dev.isDone()) delay(1);
+		for (uint8_t ch = 1; ch <= 20; ch++) dev.readTemperature(ch);
+	}
+	report("scan20/isDone+readTemperature", scans);
+	begin();
+	for (uint8_t i = 0; i < scans; i++) {
+		dev.beginMultipleConversion();
+		dev.waitUntilDone(10000);
+		dev.readResults(all, raw, status);
+	}
+	report("scan20/waitUntilDone+readResults", scans);
+	begin();
+	for (uint8_t i = 0; i < scans; i++) {
+		dev.startScan(all);
+		while (!dev.poll(raw, status)) delay(1);
+	}
+	report("scan20/startScan+poll", scans);
+	begin();
+	for (uint8_t i = 0; i < scans; i++) {
+		dev_irq.startScan(all);
+		while (!dev_irq.poll(raw, status)) delay(1);
+	}
+	report("scan20/startScan+poll/irq", scans);
+	
+	//calibration of two channels, one settling slowly, conversions included in elapsed_us
+	LTC298XTuner tuner(dev);
+	LTC298XTuning tuning;
+	chip.setSettling(4, 10000, 200);
+	begin(); tuner.tune(LTC298X_CH1 | LTC298X_CH4, 20, &tuning); report("tune/2", 1);
+	begin(); LTC298XTuner::apply(dev, tuning); report("tune/apply/unchanged", 1);
+	
+	if (!csv) printf("\n]}\n");
+	return 0;
+}
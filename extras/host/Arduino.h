@@ -0,0 +1,56 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+/****************************************************
+
+Minimal Arduino API for building the LTC298X library
+on a Linux host, see HostBoard.h for the simulation hooks.
+
+*****************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH                     0x1
+#define LOW                      0x0
+
+#define INPUT                    0x0
+#define OUTPUT                   0x1
+#define INPUT_PULLUP             0x2
+
+#define CHANGE                   1
+#define FALLING                  2
+#define RISING                   3
+
+#define LSBFIRST                 0
+#define MSBFIRST                 1
+
+#define NOT_AN_INTERRUPT         -1
+#define digitalPinToInterrupt(p) (p)
+
+#define PROGMEM
+#define pgm_read_byte(addr)      (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)      (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)     (*(const uint32_t*)(addr))
+#define memcpy_P                 memcpy
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts(void);
+void interrupts(void);
+
+#endif //Arduino_h
@@ -0,0 +1,163 @@
+#include "HostBoard.h"
+#include "SPI.h"
+#include <time.h>
+
+SPIClass SPI;
+
+static uint8_t pin_level[HOST_PINS];
+static void (*pin_isr[HOST_PINS])(void);
+static int pin_isr_mode[HOST_PINS];
+
+static HostSPIDevice* devices[HOST_MAX_DEVICES];
+static uint8_t device_cs[HOST_MAX_DEVICES];
+
+static HostBusStats bus_stats;
+
+static bool real_time = false;
+static uint64_t sim_ns = 0;
+static uint64_t real_start_ns = 0;
+
+static uint64_t monotonicNanos(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Time
+ */
+uint64_t hostNanos(void) {
+	uint64_t now = real_time ? monotonicNanos() - real_start_ns : sim_ns;
+	for (uint8_t i = 0; i < HOST_MAX_DEVICES; i++) {
+		if (devices[i]) devices[i]->update(now);
+	}
+	return now;
+}
+void hostAdvance(uint64_t ns) {
+	if (real_time) {
+		struct timespec ts = {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)};
+		nanosleep(&ts, NULL);
+	} else {
+		sim_ns += ns;
+	}
+	hostNanos();
+}
+void hostUseRealTime(bool enable) {
+	if (enable && !real_time) real_start_ns = monotonicNanos() - sim_ns;
+	if (!enable && real_time) sim_ns = monotonicNanos() - real_start_ns;
+	real_time = enable;
+}
+unsigned long millis(void) {
+	return (uint32_t)(hostNanos() / 1000000ULL);
+}
+unsigned long micros(void) {
+	return (uint32_t)(hostNanos() / 1000ULL);
+}
+void delay(unsigned long ms) {
+	hostAdvance((uint64_t)ms * 1000000ULL);
+}
+void delayMicroseconds(unsigned int us) {
+	hostAdvance((uint64_t)us * 1000ULL);
+}
+
+/*
+ * GPIO, chip selects of attached devices are routed to them
+ */
+void pinMode(uint8_t pin, uint8_t mode) {
+	if (mode == INPUT_PULLUP) pin_level[pin] = HIGH;
+}
+void digitalWrite(uint8_t pin, uint8_t val) {
+	val = val ? HIGH : LOW;
+	if (pin_level[pin] == val) return;
+	pin_level[pin] = val;
+	for (uint8_t i = 0; i < HOST_MAX_DEVICES; i++) {
+		if (!devices[i] || device_cs[i] != pin) continue;
+		if (val == LOW) {
+			bus_stats.transactions++;
+			devices[i]->select();
+		} else {
+			devices[i]->deselect();
+		}
+	}
+}
+int digitalRead(uint8_t pin) {
+	hostNanos();
+	return pin_level[pin];
+}
+/*
+ * Drive an input pin from the simulation, fires attached interrupts on matching edges.
+ */
+void hostSetPin(uint8_t pin, uint8_t level) {
+	level = level ? HIGH : LOW;
+	uint8_t old = pin_level[pin];
+	pin_level[pin] = level;
+	if (old == level || !pin_isr[pin]) return;
+	int mode = pin_isr_mode[pin];
+	if (mode == CHANGE ||
+	    (mode == RISING && level == HIGH) ||
+	    (mode == FALLING && level == LOW)
+	) pin_isr[pin]();
+}
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode) {
+	pin_isr[interrupt] = isr;
+	pin_isr_mode[interrupt] = mode;
+}
+void detachInterrupt(uint8_t interrupt) {
+	pin_isr[interrupt] = NULL;
+}
+void noInterrupts(void) {}
+void interrupts(void) {}
+
+/*
+ * Devices
+ */
+bool hostAttachDevice(HostSPIDevice* device, uint8_t cs) {
+	for (uint8_t i = 0; i < HOST_MAX_DEVICES; i++) {
+		if (devices[i]) continue;
+		devices[i] = device;
+		device_cs[i] = cs;
+		pin_level[cs] = HIGH; //idle
+		return true;
+	}
+	return false;
+}
+void hostDetachDevice(HostSPIDevice* device) {
+	for (uint8_t i = 0; i < HOST_MAX_DEVICES; i++) {
+		if (devices[i] == device) devices[i] = NULL;
+	}
+}
+HostBusStats hostBusStats(void) {
+	return bus_stats;
+}
+void hostResetBusStats(void) {
+	memset(&bus_stats, 0, sizeof(bus_stats));
+}
+
+/*
+ * SPI
+ */
+void SPIClass::begin(void) {}
+void SPIClass::end(void) {}
+void SPIClass::beginTransaction(SPISettings settings) {
+	_clock = settings.clock;
+}
+void SPIClass::endTransaction(void) {}
+uint8_t SPIClass::transfer(uint8_t data) {
+	uint8_t val = 0xFF; //MISO pulled up if nothing is selected
+	for (uint8_t i = 0; i < HOST_MAX_DEVICES; i++) {
+		if (devices[i] && pin_level[device_cs[i]] == LOW) val &= devices[i]->transfer(data);
+	}
+	uint64_t ns = 8000000000ULL / _clock;
+	bus_stats.bytes++;
+	bus_stats.busy_ns += ns;
+	if (!real_time) hostAdvance(ns);
+	return val;
+}
+uint16_t SPIClass::transfer16(uint16_t data) {
+	uint16_t val = (uint16_t)this->transfer(data >> 8) << 8;
+	return val | this->transfer(data & 0xFF);
+}
+void SPIClass::transfer(void* buf, size_t count) {
+	uint8_t* p = (uint8_t*)buf;
+	for (size_t i = 0; i < count; i++) p[i] = this->transfer(p[i]);
+}
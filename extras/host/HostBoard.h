@@ -0,0 +1,44 @@
+#ifndef HOSTBOARD_H
+#define HOSTBOARD_H
+#include "Arduino.h"
+
+/****************************************************
+
+Simulation hooks of the host Arduino shim.
+Time is simulated by default: it only advances through
+delay(), SPI traffic and hostAdvance(), which makes runs
+deterministic. Call hostUseRealTime(true) to follow the
+monotonic clock instead.
+
+*****************************************************/
+
+#define HOST_PINS                256
+#define HOST_MAX_DEVICES         8
+
+class HostSPIDevice {
+	public:
+		virtual void select(void) = 0;
+		virtual void deselect(void) = 0;
+		virtual uint8_t transfer(uint8_t data) = 0;
+		//Called whenever time has passed
+		virtual void update(uint64_t) {}
+};
+
+struct HostBusStats {
+	uint32_t transactions; //CS assertions of attached devices
+	uint32_t bytes;
+	uint64_t busy_ns;      //time spent clocking bytes
+};
+
+bool hostAttachDevice(HostSPIDevice* device, uint8_t cs);
+void hostDetachDevice(HostSPIDevice* device);
+
+void hostSetPin(uint8_t pin, uint8_t level);
+uint64_t hostNanos(void);
+void hostAdvance(uint64_t ns);
+void hostUseRealTime(bool enable);
+
+HostBusStats hostBusStats(void);
+void hostResetBusStats(void);
+
+#endif //HOSTBOARD_H
@@ -0,0 +1,188 @@
+#include "LTC298XSim.h"
+#include <math.h>
+
+#define SIM_NO_IRQ               0xFF
+
+LTC298XSim::LTC298XSim(uint8_t cs) : _irq(SIM_NO_IRQ) {
+	this->reset();
+	hostAttachDevice(this, cs);
+}
+LTC298XSim::LTC298XSim(uint8_t cs, uint8_t irq) : _irq(irq) {
+	this->reset();
+	hostAttachDevice(this, cs);
+}
+LTC298XSim::~LTC298XSim(void) {
+	hostDetachDevice(this);
+}
+
+/*
+ * Power-on state: all registers cleared, done bit set, INTERRUPT HIGH.
+ */
+void LTC298XSim::reset(void) {
+	memset(_mem, 0, sizeof(_mem));
+	_mem[0x000] = 0x40;
+	_busy = false;
+	_hang = false;
+	_phase = 0;
+	for (uint8_t i = 0; i < 20; i++) {
+		_conversion_us[i] = LTC298XSIM_CONVERSION_US;
+		_value[i] = 0;
+		_fault[i] = 0;
+		_noise[i] = 0;
+		_settle[i] = 0;
+		_settle_tau_us[i] = 1;
+	}
+	if (_irq != SIM_NO_IRQ) hostSetPin(_irq, HIGH);
+	this->resetStats();
+}
+void LTC298XSim::setConversionTime(uint8_t ch, uint32_t us) {
+	if (ch > 20 || ch == 0) return;
+	_conversion_us[ch - 1] = us;
+}
+/*
+ * Add uniform noise with rms LSB to every result of ch (deterministic sequence)
+ */
+void LTC298XSim::setNoise(uint8_t ch, uint32_t rms) {
+	if (ch > 20 || ch == 0) return;
+	_noise[ch - 1] = rms;
+}
+/*
+ * Add error * exp(-MUX delay / tau_us) to every result of ch, as an input that has not settled
+ */
+void LTC298XSim::setSettling(uint8_t ch, int32_t error, uint32_t tau_us) {
+	if (ch > 20 || ch == 0) return;
+	_settle[ch - 1] = error;
+	_settle_tau_us[ch - 1] = tau_us ? tau_us : 1;
+}
+/*
+ * Signed 24 bit result reported on the next conversion of ch, 13,10 for temperatures or 2,21 for ADC channels.
+ */
+void LTC298XSim::setValue(uint8_t ch, int32_t raw) {
+	if (ch > 20 || ch == 0) return;
+	_value[ch - 1] = raw;
+}
+/*
+ * Error flags (LTC298X_ERR_*) reported on the next conversions of ch, 0 reports a valid result again.
+ */
+void LTC298XSim::injectFault(uint8_t ch, uint8_t flags) {
+	if (ch > 20 || ch == 0) return;
+	_fault[ch - 1] = flags;
+}
+/*
+ * Conversions never finish while hang is set.
+ */
+void LTC298XSim::hang(bool hang) {
+	_hang = hang;
+}
+bool LTC298XSim::isBusy(void) {
+	return _busy;
+}
+
+uint8_t LTC298XSim::peek8(uint16_t addr) {
+	return _mem[addr & 0x3FF];
+}
+uint32_t LTC298XSim::peek32(uint16_t addr) {
+	return (uint32_t)this->peek8(addr) << 24 | (uint32_t)this->peek8(addr + 1) << 16 | (uint32_t)this->peek8(addr + 2) << 8 | this->peek8(addr + 3);
+}
+void LTC298XSim::poke8(uint16_t addr, uint8_t data) {
+	_mem[addr & 0x3FF] = data;
+}
+void LTC298XSim::resetStats(void) {
+	memset(&stats, 0, sizeof(stats));
+}
+
+/*
+ * SPI: instruction, address high, address low, then data with auto-increment until CS is released
+ */
+void LTC298XSim::select(void) {
+	_selected = true;
+	_phase = 0;
+	_cmd_written = false;
+	stats.transactions++;
+}
+void LTC298XSim::deselect(void) {
+	if (!_selected) return;
+	_selected = false;
+	//commands are executed on the rising edge of CS
+	if (_cmd_written) this->startConversion(_mem[0x000]);
+}
+uint8_t LTC298XSim::transfer(uint8_t data) {
+	if (!_selected) return 0xFF;
+	stats.bytes++;
+	switch (_phase) {
+		case 0:
+			_instr = data;
+			if (data == 0x03) stats.reads++;
+			if (data == 0x02) stats.writes++;
+			_phase++;
+			return 0xFF;
+		case 1:
+			_addr = (uint16_t)data << 8;
+			_phase++;
+			return 0xFF;
+		case 2:
+			_addr |= data;
+			_phase++;
+			return 0xFF;
+	}
+	stats.data_bytes++;
+	uint16_t addr = _addr++ & 0x3FF;
+	if (_instr == 0x03) return _mem[addr];
+	if (_instr != 0x02) return 0xFF;
+	if (addr == 0x000) {
+		if (_busy) return 0xFF; //command register is locked while converting
+		_cmd_written = true;
+	}
+	_mem[addr] = data;
+	return 0xFF;
+}
+
+/*
+ * Conversions
+ */
+void LTC298XSim::startConversion(uint8_t cmd) {
+	if ((cmd & 0xE0) != 0x80) return; //sleep or invalid, nothing to convert
+	uint8_t ch = cmd & 0x1F;
+	if (ch > 20) return;
+	if (ch) {
+		_converting = (uint32_t)1 << (ch - 1);
+	} else {
+		_converting = ((uint32_t)_mem[0x0F5] << 16 | (uint32_t)_mem[0x0F6] << 8 | _mem[0x0F7]) & 0xFFFFF;
+	}
+	uint64_t duration_ns = 0;
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(_converting & ((uint32_t)1 << i))) continue;
+		duration_ns += ((uint64_t)_conversion_us[i] + (uint64_t)_mem[0x0FF] * LTC298XSIM_MUX_UNIT_US) * 1000;
+	}
+	stats.conversions++;
+	_done_at = hostNanos() + duration_ns; //before setting busy, hostNanos() updates all devices
+	_busy = true;
+	if (_irq != SIM_NO_IRQ) hostSetPin(_irq, LOW);
+}
+void LTC298XSim::finishConversion(void) {
+	for (uint8_t i = 0; i < 20; i++) {
+		if (!(_converting & ((uint32_t)1 << i))) continue;
+		if (!this->peek32(0x200 + i * 4)) continue; //unassigned channels are not converted
+		uint8_t status = _fault[i];
+		if (!(status & 0xE0)) status |= 0x01; //valid unless a hard fault is present
+		int32_t value = _value[i];
+		if (_settle[i]) value += (int32_t)lround(_settle[i] * exp(-(double)_mem[0x0FF] * LTC298XSIM_MUX_UNIT_US / _settle_tau_us[i]));
+		if (_noise[i]) {
+			_seed = _seed * 1103515245 + 12345;
+			double uniform = ((_seed >> 8) & 0xFFFF) / 65535.0 - 0.5; //rms of 1/sqrt(12)
+			value += (int32_t)lround(uniform * 3.4641016 * _noise[i]);
+		}
+		uint32_t word = (uint32_t)status << 24 | (value & 0xFFFFFF);
+		uint16_t addr = 0x010 + i * 4;
+		_mem[addr]     = word >> 24;
+		_mem[addr + 1] = word >> 16;
+		_mem[addr + 2] = word >> 8;
+		_mem[addr + 3] = word;
+	}
+	_mem[0x000] = 0x40 | (_mem[0x000] & 0x1F);
+	_busy = false;
+	if (_irq != SIM_NO_IRQ) hostSetPin(_irq, HIGH);
+}
+void LTC298XSim::update(uint64_t now_ns) {
+	if (_busy && !_hang && now_ns >= _done_at) this->finishConversion();
+}
@@ -0,0 +1,82 @@
+#ifndef LTC298XSIM_H
+#define LTC298XSIM_H
+#include "HostBoard.h"
+
+/****************************************************
+
+Register level model of the LTC2983/4/6 for host builds.
+Models the SPI instruction set with address auto-increment,
+the command register with start and done bits, single and
+multiple conversions using the mask at 0x0F4, the
+configuration and custom RAM as plain memory, result words
+and the INTERRUPT pin. Results and faults are injected per
+channel, conversion time is configurable. Optional noise
+and a settling error decaying with the MUX delay make
+results depend on the settings.
+
+*****************************************************/
+
+#define LTC298XSIM_CONVERSION_US 167000 //per converted channel
+#define LTC298XSIM_MUX_UNIT_US   10     //MUX delay register unit
+
+struct LTC298XSimStats {
+	uint32_t transactions;
+	uint32_t reads;        //read instructions
+	uint32_t writes;       //write instructions
+	uint32_t bytes;        //including instruction and address
+	uint32_t data_bytes;
+	uint32_t conversions;  //started conversion commands
+};
+
+class LTC298XSim : public HostSPIDevice {
+	private:
+		uint8_t _mem[0x400];
+		uint8_t _irq;
+		uint8_t _phase = 0;
+		uint8_t _instr = 0;
+		uint16_t _addr = 0;
+		bool _selected = false;
+		bool _cmd_written = false;
+		bool _busy = false;
+		bool _hang = false;
+		uint32_t _converting = 0;
+		uint64_t _done_at = 0;
+		uint32_t _conversion_us[20];
+		int32_t _value[20];
+		uint8_t _fault[20];
+		uint32_t _noise[20];
+		int32_t _settle[20];
+		uint32_t _settle_tau_us[20];
+		uint32_t _seed = 1;
+		
+		void startConversion(uint8_t cmd);
+		void finishConversion(void);
+		
+	public:
+		LTC298XSim(uint8_t cs);
+		LTC298XSim(uint8_t cs, uint8_t irq);
+		~LTC298XSim(void);
+		
+		void reset(void);
+		void setConversionTime(uint8_t ch, uint32_t us);
+		void setValue(uint8_t ch, int32_t raw);
+		void injectFault(uint8_t ch, uint8_t flags);
+		void setNoise(uint8_t ch, uint32_t rms);
+		void setSettling(uint8_t ch, int32_t error, uint32_t tau_us);
+		void hang(bool hang);
+		bool isBusy(void);
+		
+		uint8_t peek8(uint16_t addr);
+		uint32_t peek32(uint16_t addr);
+		void poke8(uint16_t addr, uint8_t data);
+		
+		LTC298XSimStats stats;
+		void resetStats(void);
+		
+		virtual void select(void);
+		virtual void deselect(void);
+		virtual uint8_t transfer(uint8_t data);
+		virtual void update(uint64_t now_ns);
+};
+
+#endif //LTC298XSIM_H
@@ -0,0 +1,43 @@
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+#include "Arduino.h"
+
+/****************************************************
+
+Host SPI, bytes are routed to the HostSPIDevice whose
+chip select is LOW and the simulated clock advances
+by the time each byte takes at the configured SCK.
+
+*****************************************************/
+
+#define SPI_MODE0                0x00
+#define SPI_MODE1                0x04
+#define SPI_MODE2                0x08
+#define SPI_MODE3                0x0C
+
+class SPISettings {
+	public:
+		SPISettings(void) : clock(4000000), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+		SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+		uint32_t clock;
+		uint8_t bitOrder;
+		uint8_t dataMode;
+};
+
+class SPIClass {
+	private:
+		uint32_t _clock = 4000000;
+		
+	public:
+		void begin(void);
+		void end(void);
+		void beginTransaction(SPISettings settings);
+		void endTransaction(void);
+		uint8_t transfer(uint8_t data);
+		uint16_t transfer16(uint16_t data);
+		void transfer(void* buf, size_t count);
+};
+
+extern SPIClass SPI;
+
+#endif //_SPI_H_INCLUDED
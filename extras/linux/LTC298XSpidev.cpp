@@ -0,0 +1,215 @@
+#include "LTC298XSpidev.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+LTC298XSpidev::LTC298XSpidev(const char* path) : _path(path), _clock(LTC298X_SPI_CLOCK) {}
+LTC298XSpidev::LTC298XSpidev(const char* path, uint32_t clock) : _path(path), _clock(clock) {}
+LTC298XSpidev::~LTC298XSpidev(void) {
+	this->flush();
+	if (_fd >= 0) close(_fd);
+}
+
+/*
+ * Keep transactions without reads (register writes, commands) in the queue until the next read,
+ * flush() or a full queue. Call flush() before waiting for a conversion started this way,
+ * LTC298XGpioIrq::wait() does so.
+ */
+void LTC298XSpidev::queueWrites(bool enable) {
+	_queue = enable;
+	if (!enable) this->flush();
+}
+void LTC298XSpidev::flush(void) {
+	this->send(false);
+}
+/*
+ * Number of SPI_IOC_MESSAGE ioctls issued
+ */
+uint32_t LTC298XSpidev::messages(void) {
+	return _messages;
+}
+/*
+ * True if opening or any transfer failed since begin()
+ */
+bool LTC298XSpidev::failed(void) {
+	return _error;
+}
+/*
+ * errno of the last message, 0 if it went through. Transactions with reads are sent by their
+ * endTransaction(), so afterwards this is their own result; queued writes report with the message
+ * that carries them. Read buffers of a failed message are zeroed, results read as not valid.
+ */
+int LTC298XSpidev::error(void) {
+	return _last_error;
+}
+
+int LTC298XSpidev::message(struct spi_ioc_transfer* xfer, uint8_t count) {
+	if (_fd < 0) return EBADF;
+	return ioctl(_fd, SPI_IOC_MESSAGE(count), xfer) < 0 ? errno : 0;
+}
+/*
+ * cs_change toggles CS after every transaction, on the last transfer of a message it keeps CS asserted instead
+ */
+void LTC298XSpidev::send(bool keep_cs) {
+	if (!_count) return;
+	_xfer[_count - 1].cs_change = keep_cs;
+	_last_error = this->message(_xfer, _count);
+	if (_last_error) {
+		_error = true;
+		for (uint8_t i = 0; i < _count; i++) {
+			if (_xfer[i].rx_buf) memset((uint8_t*)(uintptr_t)_xfer[i].rx_buf, 0, _xfer[i].len);
+		}
+	}
+	_messages++;
+	_count = 0;
+	_txn_start = 0;
+	_has_rx = false;
+	_bytes = 0;
+}
+
+void LTC298XSpidev::begin(void) {
+	_error = false;
+	if (_fd < 0) _fd = open(_path, O_RDWR);
+	if (_fd < 0) {
+		_error = true;
+		return;
+	}
+	uint8_t mode = SPI_MODE_0;
+	uint8_t bits = 8;
+	if (ioctl(_fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+	    ioctl(_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+	    ioctl(_fd, SPI_IOC_WR_MAX_SPEED_HZ, &_clock) < 0
+	) _error = true;
+}
+void LTC298XSpidev::beginTransaction(void) {
+	_txn_start = _count;
+}
+void LTC298XSpidev::endTransaction(void) {
+	if (_count > _txn_start) _xfer[_count - 1].cs_change = 1;
+	//read data must be in place when the driver returns
+	if (!_queue || _has_rx) this->send(false);
+}
+static uint16_t aligned(uint32_t len) {
+	return (len + LTC298X_SPIDEV_ALIGN - 1) / LTC298X_SPIDEV_ALIGN * LTC298X_SPIDEV_ALIGN;
+}
+/*
+ * Writes following a write of the same transaction extend its transfer, every transfer costs
+ * at least LTC298X_SPIDEV_ALIGN bytes of bufsiz
+ */
+void LTC298XSpidev::transfer(const uint8_t* tx, uint8_t* rx, uint16_t len) {
+	while (len) {
+		struct spi_ioc_transfer* xfer = _count > _txn_start ? &_xfer[_count - 1] : NULL;
+		if (xfer && tx && !rx && xfer->tx_buf && !xfer->rx_buf) {
+			uint16_t offset = (uint16_t)(xfer->tx_buf - (uintptr_t)_tx) + xfer->len;
+			if (offset < LTC298X_SPIDEV_BUFSIZ) {
+				uint16_t n = len < LTC298X_SPIDEV_BUFSIZ - offset ? len : LTC298X_SPIDEV_BUFSIZ - offset;
+				memcpy(_tx + offset, tx, n);
+				xfer->len += n;
+				_bytes = aligned(offset + n);
+				tx += n;
+				len -= n;
+				continue;
+			}
+		}
+		if (_count == LTC298X_SPIDEV_MAX_XFER || _bytes == LTC298X_SPIDEV_BUFSIZ) this->send(_count > _txn_start); //an open transaction continues in the next message
+		uint16_t n = len < LTC298X_SPIDEV_BUFSIZ - _bytes ? len : LTC298X_SPIDEV_BUFSIZ - _bytes;
+		xfer = &_xfer[_count++];
+		memset(xfer, 0, sizeof(*xfer));
+		if (tx) {
+			//copied, queued writes outlive the caller's buffer
+			memcpy(_tx + _bytes, tx, n);
+			xfer->tx_buf = (uintptr_t)(_tx + _bytes);
+			tx += n;
+		}
+		if (rx) {
+			xfer->rx_buf = (uintptr_t)rx;
+			rx += n;
+			_has_rx = true;
+		}
+		xfer->len = n;
+		xfer->speed_hz = _clock;
+		xfer->bits_per_word = 8;
+		_bytes += aligned(n);
+		len -= n;
+	}
+}
+
+/*
+ * INTERRUPT of a chip on line of a GPIO character device (e.g. "/dev/gpiochip0"), rising edge.
+ * bus is flushed before waiting, so queued commands reach the chip.
+ */
+LTC298XGpioIrq::LTC298XGpioIrq(LTC298XSpidev& bus, const char* chip, uint32_t line) :
+	_bus(bus), _chip(chip), _line(line) {}
+LTC298XGpioIrq::~LTC298XGpioIrq(void) {
+	if (_fd >= 0) close(_fd);
+}
+bool LTC298XGpioIrq::begin(void) {
+	int chip = open(_chip, O_RDWR);
+	if (chip < 0) return false;
+	struct gpio_v2_line_request req;
+	memset(&req, 0, sizeof(req));
+	req.offsets[0] = _line;
+	req.num_lines = 1;
+	req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING;
+	strncpy(req.consumer, "ltc298x", sizeof(req.consumer) - 1);
+	bool ok = ioctl(chip, GPIO_V2_GET_LINE_IOCTL, &req) >= 0;
+	close(chip);
+	if (!ok) return false;
+	_fd = req.fd;
+	return true;
+}
+/*
+ * Level of the line, -1 on error
+ */
+int LTC298XGpioIrq::level(void) {
+	struct gpio_v2_line_values values;
+	values.bits = 0;
+	values.mask = 1;
+	if (ioctl(_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) return -1;
+	return values.bits & 1;
+}
+/*
+ * Block until INTERRUPT rises or timeout_ms (-1 waits forever), then mark the conversion of device as done.
+ * INTERRUPT is low while converting: a conversion that already finished returns at once, edges left over
+ * from earlier conversions are drained or skipped by checking the level.
+ * Returns false on timeout, poll() may be called afterwards without reading the command register.
+ */
+bool LTC298XGpioIrq::wait(LTC298XDevice& device, int timeout_ms) {
+	_bus.flush();
+	if (_fd < 0) return false;
+	struct gpio_v2_line_event events[4];
+	struct pollfd pfd = {_fd, POLLIN, 0};
+	int high = this->level();
+	if (high < 0) return false;
+	if (high) {
+		while (poll(&pfd, 1, 0) > 0 && read(_fd, events, sizeof(events)) > 0);
+		device.handleInterrupt();
+		return true;
+	}
+	uint32_t start = millis();
+	while (true) {
+		int remaining = -1;
+		if (timeout_ms >= 0) {
+			uint32_t elapsed = millis() - start;
+			if (elapsed >= (uint32_t)timeout_ms) return false;
+			remaining = timeout_ms - elapsed;
+		}
+		if (poll(&pfd, 1, remaining) <= 0) return false;
+		if (read(_fd, events, sizeof(events)) < (ssize_t)sizeof(events[0])) return false;
+		high = this->level();
+		if (high < 0) return false;
+		if (!high) continue; //stale edge, still converting
+		device.handleInterrupt();
+		return true;
+	}
+}
+/*
+ * File descriptor becoming readable on an edge, for epoll based event loops
+ */
+int LTC298XGpioIrq::fd(void) {
+	return _fd;
+}
@@ -0,0 +1,82 @@
+#ifndef LTC298XSPIDEV_H
+#define LTC298XSPIDEV_H
+#include <LTC298X.h>
+#include <linux/spi/spidev.h>
+
+/****************************************************
+
+Linux userspace backend for the LTC298X library.
+LTC298XSpidev runs the driver over /dev/spidevX.Y and
+collects every access of a transaction (and optionally
+queued writes of several transactions) into a single
+SPI_IOC_MESSAGE ioctl. LTC298XGpioIrq waits for
+INTERRUPT on a GPIO character device line.
+
+Build together with the Arduino shim of extras/host,
+with hostUseRealTime(true) for millis()/delay().
+
+*****************************************************/
+
+#define LTC298X_SPIDEV_MAX_XFER  64   //transfers per ioctl
+#define LTC298X_SPIDEV_BUFSIZ    4096 //spidev bufsiz module parameter, bytes per ioctl
+#ifndef LTC298X_SPIDEV_ALIGN
+#define LTC298X_SPIDEV_ALIGN     128  //spidev rounds every transfer up to ARCH_DMA_MINALIGN against bufsiz, 128 covers arm64
+#endif
+#if LTC298X_SPIDEV_BUFSIZ % LTC298X_SPIDEV_ALIGN
+#error "LTC298X_SPIDEV_BUFSIZ must be a multiple of LTC298X_SPIDEV_ALIGN"
+#endif
+
+class LTC298XSpidev : public LTC298XTransport {
+	private:
+		const char* _path;
+		uint32_t _clock;
+		int _fd = -1;
+		bool _queue = false;
+		bool _error = false;
+		int _last_error = 0;
+		struct spi_ioc_transfer _xfer[LTC298X_SPIDEV_MAX_XFER];
+		uint8_t _count = 0;
+		uint8_t _txn_start = 0;
+		bool _has_rx = false;
+		uint16_t _bytes = 0; //bufsiz used, transfers rounded up to LTC298X_SPIDEV_ALIGN
+		uint8_t _tx[LTC298X_SPIDEV_BUFSIZ];
+		uint32_t _messages = 0;
+		void send(bool keep_cs);
+		
+	protected:
+		//Issue count transfers as one message, returns 0 or errno, override to run against a stand-in
+		virtual int message(struct spi_ioc_transfer* xfer, uint8_t count);
+		
+	public:
+		LTC298XSpidev(const char* path);
+		LTC298XSpidev(const char* path, uint32_t clock);
+		virtual ~LTC298XSpidev(void);
+		void queueWrites(bool enable);
+		void flush(void);
+		uint32_t messages(void);
+		bool failed(void);
+		int error(void);
+		
+		virtual void begin(void);
+		virtual void beginTransaction(void);
+		virtual void endTransaction(void);
+		virtual void transfer(const uint8_t* tx, uint8_t* rx, uint16_t len);
+};
+
+class LTC298XGpioIrq {
+	private:
+		LTC298XSpidev& _bus;
+		const char* _chip;
+		uint32_t _line;
+		int _fd = -1;
+		int level(void);
+		
+	public:
+		LTC298XGpioIrq(LTC298XSpidev& bus, const char* chip, uint32_t line);
+		~LTC298XGpioIrq(void);
+		bool begin(void);
+		bool wait(LTC298XDevice& device, int timeout_ms);
+		int fd(void);
+};
+
+#endif //LTC298XSPIDEV_H
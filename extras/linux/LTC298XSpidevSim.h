@@ -0,0 +1,64 @@
+#ifndef LTC298XSPIDEVSIM_H
+#define LTC298XSPIDEVSIM_H
+#include "LTC298XSpidev.h"
+#include <SPI.h>
+#include <errno.h>
+
+/****************************************************
+
+Stand-in for /dev/spidevX.Y: replays every message on
+the SPI bus of the host shim, e.g. to an LTC298XSim
+attached to cs, and keeps the message count of the
+real backend. For tests without spidev hardware.
+Messages over bufsiz fail with EMSGSIZE as in the
+kernel, failNext() makes the next message fail.
+
+*****************************************************/
+
+class LTC298XSpidevSim : public LTC298XSpidev {
+	private:
+		uint8_t _cs;
+		int _fail = 0;
+		
+	protected:
+		virtual int message(struct spi_ioc_transfer* xfer, uint8_t count) {
+			int fail = _fail;
+			_fail = 0;
+			if (fail) return fail;
+			uint32_t tx_total = 0, rx_total = 0;
+			for (uint8_t i = 0; i < count; i++) {
+				uint32_t len = (xfer[i].len + LTC298X_SPIDEV_ALIGN - 1) / LTC298X_SPIDEV_ALIGN * LTC298X_SPIDEV_ALIGN;
+				if (xfer[i].tx_buf) tx_total += len;
+				if (xfer[i].rx_buf) rx_total += len;
+			}
+			if (tx_total > LTC298X_SPIDEV_BUFSIZ || rx_total > LTC298X_SPIDEV_BUFSIZ) return EMSGSIZE;
+			digitalWrite(_cs, LOW);
+			for (uint8_t i = 0; i < count; i++) {
+				const uint8_t* tx = (const uint8_t*)(uintptr_t)xfer[i].tx_buf;
+				uint8_t* rx = (uint8_t*)(uintptr_t)xfer[i].rx_buf;
+				for (uint32_t j = 0; j < xfer[i].len; j++) {
+					uint8_t val = SPI.transfer(tx ? tx[j] : 0);
+					if (rx) rx[j] = val;
+				}
+				if (xfer[i].cs_change && i + 1 < count) {
+					digitalWrite(_cs, HIGH);
+					digitalWrite(_cs, LOW);
+				}
+			}
+			if (!xfer[count - 1].cs_change) digitalWrite(_cs, HIGH);
+			return 0;
+		}
+		
+	public:
+		LTC298XSpidevSim(uint8_t cs) : LTC298XSpidev("sim"), _cs(cs) {}
+		virtual void begin(void) {
+			digitalWrite(_cs, HIGH);
+			pinMode(_cs, OUTPUT);
+			SPI.begin();
+		}
+		void failNext(int err) {
+			_fail = err;
+		}
+};
+
+#endif //LTC298XSPIDEVSIM_H
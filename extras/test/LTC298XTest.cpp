@@ -0,0 +1,931 @@
+/****************************************************
+
+Regression tests for the LTC298X library, run against
+the simulated chip of extras/host and the spidev
+stand-in of extras/linux. Exits with 1 if any check
+fails.
+
+g++ -std=c++11 -I. -Iextras/host -Iextras/linux extras/test/LTC298XTest.cpp *.cpp extras/host/HostBoard.cpp extras/host/LTC298XSim.cpp extras/linux/LTC298XSpidev.cpp -o ltc298x_test
+./ltc298x_test
+
+*****************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "LTC298X.h"
+#include "LTC298XConfig.h"
+#include "LTC298XCurveFit.h"
+#include "LTC298XFilter.h"
+#include "LTC298XFrame.h"
+#include "LTC298XGroup.h"
+#include "LTC298XLinearizer.h"
+#include "LTC298XScheduler.h"
+#include "LTC298XSim.h"
+#include "LTC298XSpidevSim.h"
+#include "LTC298XTuner.h"
+
+#define TEST_CS                  10
+#define TEST_IRQ                 2
+
+static uint16_t checks = 0;
+static uint16_t failures = 0;
+
+#define CHECK(cond) check((cond), #cond, __FILE__, __LINE__)
+static void check(bool ok, const char* cond, const char* file, int line) {
+	checks++;
+	if (ok) return;
+	failures++;
+	printf("%s:%d: check failed: %s\n", file, line, cond);
+}
+
+static void fillTable(double* x, double* kelvin, uint8_t n, double x0, double dx) {
+	for (uint8_t i = 0; i < n; i++) {
+		x[i] = x0 + i * dx;
+		kelvin[i] = 100 + i * 10;
+	}
+}
+static uint8_t tableAddr(LTC298XSim& chip, uint8_t ch) {
+	return (chip.peek32(0x200 + (ch - 1) * 4) >> 6) & 0x3F;
+}
+
+/*
+ * Sign extension of 24 bit results, status bytes and the fixed point conversions
+ */
+static void testResults(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupThermocouple(4, LTC298X_TYPE_TC_K, 1, true);
+	dev.setupADC(6, true);
+	chip.setValue(1, 25 * 1024);
+	chip.setValue(4, -40 * 1024 - 512);
+	chip.setValue(6, -2097152); //-1 V
+	chip.injectFault(4, LTC298X_ERR_CJ_SOFTFAIL);
+	dev.startScan(LTC298X_CH1 | LTC298X_CH4 | LTC298X_CH6);
+	int32_t raw[20];
+	uint8_t status[20];
+	while (!dev.poll(raw, status)) delay(1);
+	CHECK(raw[0] == 25 * 1024 && status[0] == 0x01);
+	CHECK(raw[3] == -40 * 1024 - 512 && status[3] == (LTC298X_ERR_CJ_SOFTFAIL | 0x01));
+	CHECK(raw[5] == -2097152);
+	CHECK(LTC298X::rawToMilli(raw[3]) == -40500);
+	CHECK(LTC298X::rawToMicrovolts(raw[5]) == -1000000);
+	uint8_t st = 0;
+	CHECK(dev.readRaw(4, &st) == raw[3] && st == status[3]);
+	CHECK(dev.readTemperatureMilli(1, &st) == 25000);
+	CHECK(dev.readRaw(21, NULL) == LTC298X_INVALID_RAW);
+	chip.injectFault(4, LTC298X_ERR_SEN_HARDFAIL);
+	dev.startScan(LTC298X_CH4);
+	while (!dev.poll(raw, status)) delay(1);
+	CHECK(!(status[3] & 0x01));
+}
+
+/*
+ * Staged assignments stay off the chip until commitConfig(), which writes them in one burst
+ */
+static void testStaging(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.beginConfig();
+	dev.setupSenseResistor(3, 2000);
+	dev.setupThermocouple(4, LTC298X_TYPE_TC_K, 1, true);
+	dev.setupThermocouple(5, LTC298X_TYPE_TC_J, 1, true);
+	CHECK(chip.peek32(0x200 + 3 * 4) == 0);
+	chip.resetStats();
+	dev.commitConfig();
+	CHECK(chip.stats.writes == 1);
+	CHECK(chip.peek32(0x200 + 3 * 4) >> 27 == LTC298X_TYPE_TC_K);
+	CHECK(chip.peek32(0x200 + 4 * 4) >> 27 == LTC298X_TYPE_TC_J);
+	CHECK(chip.peek32(0x200 + 2 * 4) >> 27 == LTC298X_TYPE_SENSERES);
+	//committed custom tables are not touched before the commit
+	double x[30];
+	double kelvin[30];
+	fillTable(x, kelvin, 30, 10, 5);
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 30));
+	uint32_t word = chip.peek32(0x200 + 7 * 4);
+	uint8_t before[180];
+	for (uint8_t i = 0; i < 180; i++) before[i] = chip.peek8(0x250 + i);
+	dev.beginConfig();
+	kelvin[10] += 0.5;
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 30));
+	bool kept = chip.peek32(0x200 + 7 * 4) == word;
+	for (uint8_t i = 0; i < 180; i++) kept = kept && before[i] == chip.peek8(0x250 + i);
+	CHECK(kept);
+	dev.commitConfig();
+	CHECK(tableAddr(chip, 8) != ((word >> 6) & 0x3F));
+}
+
+/*
+ * Identical tables are shared, freed space is reused and fragmented space compacted
+ */
+static void testAllocator(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupSenseResistor(3, 2000);
+	double x[40];
+	double kelvin[40];
+	fillTable(x, kelvin, 40, 10, 5);
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 40));
+	CHECK(dev.setupCustomRTD(10, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 40));
+	CHECK(tableAddr(chip, 8) == tableAddr(chip, 10)); //shared
+	CHECK(dev.freeRam() == 384 - 240);
+	//three tables of 80 byte (20 words) each, free the middle one
+	fillTable(x, kelvin, 13, 10, 5);
+	dev.disableChannel(8);
+	dev.disableChannel(10);
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 13));
+	fillTable(x, kelvin, 13, 20, 5);
+	CHECK(dev.setupCustomRTD(10, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 13));
+	fillTable(x, kelvin, 13, 30, 5);
+	CHECK(dev.setupCustomRTD(12, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 13));
+	dev.disableChannel(10);
+	//the largest gap is smaller than the free space, the table of ch 12 is moved down
+	uint8_t addr12 = tableAddr(chip, 12);
+	fillTable(x, kelvin, 35, 40, 5); //53 words, 56 free
+	CHECK(dev.setupCustomRTD(14, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 35));
+	CHECK(tableAddr(chip, 12) < addr12);
+	CHECK(chip.peek8(0x250 + tableAddr(chip, 12) * 4 + 2) == (uint8_t)(30 * 2048)); //low byte of 30 ohm
+	CHECK(chip.peek8(0x250 + tableAddr(chip, 14) * 4 + 2) == (uint8_t)(40 * 2048));
+	//overlap with a live table is refused
+	fillTable(x, kelvin, 4, 50, 5);
+	CHECK(!dev.setupCustomRTD(16, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 4, tableAddr(chip, 14)));
+}
+
+/*
+ * Setting up an unchanged table again writes nothing, with and without LTC298X_RAM_SHADOW
+ */
+static void testTableUpdate(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupSenseResistor(3, 2000);
+	double x[20];
+	double kelvin[20];
+	fillTable(x, kelvin, 20, 10, 5);
+	float coeff[6] = {1.1e-3, 2.3e-4, 0, 9e-8, 0, 0};
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 20));
+	CHECK(dev.setupSteinhartHartThermistor(10, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO, coeff));
+	chip.resetStats();
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 20));
+	CHECK(dev.setupSteinhartHartThermistor(10, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO, coeff));
+	CHECK(chip.stats.writes == 0);
+	kelvin[5] += 1;
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 20));
+	CHECK(chip.stats.writes > 0);
+	uint16_t row = 0x250 + tableAddr(chip, 8) * 4 + 5 * 6;
+	CHECK((chip.peek32(row + 2) & 0xFFFFFF) == (uint32_t)(151 * 1024));
+}
+
+/*
+ * PROGMEM table rows encode like the runtime setup functions
+ */
+static const uint8_t test_rows[] PROGMEM = {
+	LTC298X_ROW_TC(0, 273.15),
+	LTC298X_ROW_TC(-1.5, 235.5),
+	LTC298X_ROW_RTD(100.5, 273.15),
+	LTC298X_ROW_THERMISTOR(10000.25, 298.15)
+};
+static void testRows(void) {
+	static const uint8_t expected[] = {
+		0x00, 0x00, 0x00, 0x04, 0x44, 0x99, //0 mV, 273.15 K = 279705.6
+		0xFF, 0xA0, 0x00, 0x03, 0xAE, 0x00, //-1.5 mV = -24576, 235.5 K = 241152
+		0x03, 0x24, 0x00, 0x04, 0x44, 0x99, //100.5 ohm = 205824
+		0x02, 0x71, 0x04, 0x04, 0xA8, 0x99  //10000.25 ohm = 160004, 298.15 K = 305305.6
+	};
+	CHECK(sizeof(test_rows) == sizeof(expected) && !memcmp(test_rows, expected, sizeof(expected)));
+	//loadTable() uploads the same bytes as setupCustomRTD()
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	double ohm[3] = {100.5, 120.25, 140};
+	double kelvin[3] = {273.15, 323.5, 373.15};
+	static const uint8_t table[] PROGMEM = {
+		LTC298X_ROW_RTD(100.5, 273.15),
+		LTC298X_ROW_RTD(120.25, 323.5),
+		LTC298X_ROW_RTD(140, 373.15)
+	};
+	dev.setupSenseResistor(3, 2000);
+	CHECK(dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, ohm, kelvin, 3, 0));
+	dev.disableChannel(8);
+	CHECK(dev.loadTable(20, table, sizeof(table)));
+	bool same = true;
+	for (uint8_t i = 0; i < sizeof(table); i++) same = same && chip.peek8(0x250 + i) == chip.peek8(0x250 + 80 + i);
+	CHECK(same);
+}
+
+/*
+ * Template channel words match the runtime setup functions, loadConfig() writes them with one burst
+ */
+typedef LTC298XDiode<2, true, false, false, DIODE_CURRENT_10uA> TestCJ;
+typedef LTC298XSenseResistor<3, LTC298X_OHM(2000)> TestRsense;
+typedef LTC298XThermocouple<4, LTC298X_TYPE_TC_K, 2, true> TestTC;
+typedef LTC298XCustomRTD<8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, 20, 3> TestRTD;
+typedef LTC298XThermistor<10, LTC298X_TYPE_THER_44006, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO> TestTherm;
+typedef LTC298XADC<12, true> TestADC;
+typedef LTC298XConfigImage<TestTC, TestCJ, TestRsense, TestRTD, TestTherm, TestADC> TestConfig;
+static void testConfigImage(void) {
+	static const uint8_t table[] PROGMEM = {
+		LTC298X_ROW_RTD(100.5, 273.15),
+		LTC298X_ROW_RTD(120.25, 323.5),
+		LTC298X_ROW_RTD(140, 373.15)
+	};
+	uint8_t expected[80];
+	{
+		LTC298XSim chip(TEST_CS);
+		LTC298X dev(TEST_CS);
+		dev.begin();
+		double ohm[3] = {100.5, 120.25, 140};
+		double kelvin[3] = {273.15, 323.5, 373.15};
+		dev.setupDiode(2, true, false, false, DIODE_CURRENT_10uA);
+		dev.setupSenseResistor(3, 2000);
+		dev.setupThermocouple(4, LTC298X_TYPE_TC_K, 2, true);
+		dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, ohm, kelvin, 3, 20);
+		dev.setupThermistor(10, LTC298X_TYPE_THER_44006, 3, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO);
+		dev.setupADC(12, true);
+		for (uint8_t i = 0; i < 80; i++) expected[i] = chip.peek8(0x200 + i);
+	}
+	CHECK(TestConfig::words[0] == 0 && TestConfig::words[3] == TestTC::word);
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	chip.resetStats();
+	dev.loadConfig(TestConfig::words);
+	CHECK(dev.loadTable(20, table, sizeof(table)));
+	CHECK(chip.stats.writes == 2);
+	bool same = true;
+	for (uint8_t i = 0; i < 80; i++) same = same && chip.peek8(0x200 + i) == expected[i];
+	CHECK(same);
+	CHECK(dev.freeRam() == 384 - 20); //the table referenced by ch 8 is allocated
+	CHECK(!dev.loadTable(64, table, sizeof(table)));
+	//staged like the setup functions
+	chip.reset();
+	dev.invalidateCache();
+	dev.beginConfig();
+	dev.loadConfig(TestConfig::words);
+	CHECK(chip.peek32(0x200 + 3 * 4) == 0);
+	dev.commitConfig();
+	CHECK(chip.peek32(0x200 + 3 * 4) == TestTC::word);
+}
+
+/*
+ * A saved image restores the exact register state on a reset chip
+ */
+static void testImage(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.reject50Hz();
+	dev.setMuxDelay(50);
+	dev.setupSenseResistor(3, 2000);
+	dev.setupThermocouple(4, LTC298X_TYPE_TC_K, 1, true);
+	double x[10];
+	double kelvin[10];
+	fillTable(x, kelvin, 10, 10, 5);
+	dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 10);
+	dev.selectConversionChannels(LTC298X_CH4 | LTC298X_CH8);
+	uint8_t image[LTC298X_IMAGE_MAX];
+	uint16_t len = dev.saveImage(image, sizeof(image));
+	CHECK(len == LTC298X_IMAGE_HEADER + 80 + 60);
+	uint8_t before[0x200];
+	for (uint16_t i = 0; i < sizeof(before); i++) before[i] = chip.peek8(0x0F0 + i);
+	chip.reset();
+	dev.invalidateCache();
+	CHECK(dev.restoreImage(image, len));
+	bool same = true;
+	for (uint16_t i = 0; i < sizeof(before); i++) same = same && before[i] == chip.peek8(0x0F0 + i);
+	CHECK(same);
+	image[0] ^= 0xFF;
+	CHECK(!dev.restoreImage(image, len));
+	CHECK(!dev.restoreImage(image, 20));
+	image[0] ^= 0xFF;
+	image[5] |= 0x10; //channel 21
+	CHECK(!dev.restoreImage(image, len));
+	image[5] &= 0x0F;
+	image[4] = 0x01;
+	CHECK(!dev.restoreImage(image, len));
+	image[4] = 0;
+	CHECK(dev.restoreImage(image, len));
+	//staged words are neither lost nor saved
+	dev.beginConfig();
+	dev.setupThermocouple(5, LTC298X_TYPE_TC_J, 1, true);
+	CHECK(dev.saveImage(image, sizeof(image)) == 0);
+	dev.commitConfig();
+	CHECK(chip.peek32(0x200 + 4 * 4) >> 27 == LTC298X_TYPE_TC_J);
+	CHECK(dev.saveImage(image, sizeof(image)) == len);
+}
+
+/*
+ * Starting a conversion costs one write, the duration is estimated when first needed
+ * and waitUntilDone() sleeps through most of it
+ */
+static void testConversionTime(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupThermocouple(4, LTC298X_TYPE_TC_K, 1, true);
+	dev.selectConversionChannels(LTC298X_CH1 | LTC298X_CH4);
+	//diode 2 cycles, thermocouple 2 cycles and its cold junction diode 2 more
+	const uint32_t expected = 6 * LTC298X_CYCLE_US_6050HZ;
+	chip.setConversionTime(1, 2 * LTC298X_CYCLE_US_6050HZ);
+	chip.setConversionTime(4, 4 * LTC298X_CYCLE_US_6050HZ);
+	dev.invalidateCache();
+	chip.resetStats();
+	dev.beginMultipleConversion();
+	CHECK(chip.stats.reads == 0 && chip.stats.writes == 1);
+	uint32_t left = dev.timeUntilDone();
+	CHECK(left <= expected && left > expected - 5000);
+	CHECK(chip.stats.reads > 0);
+	chip.resetStats();
+	CHECK(dev.waitUntilDone(1000));
+	CHECK(chip.stats.reads <= 5); //command register polls near the predicted end
+	CHECK(!dev.isDone() == chip.isBusy());
+	//an unfinished conversion times out
+	chip.hang(true);
+	dev.beginMultipleConversion();
+	CHECK(!dev.waitUntilDone(100));
+	chip.hang(false);
+	delay(1000);
+	//the selected channels are read back once the shadow copy is invalid
+	chip.poke8(0x0F7, 0);
+	chip.poke8(0x0F6, 0);
+	chip.poke8(0x0F5, 0);
+	chip.poke8(0x0F7, LTC298X_CH4);
+	dev.invalidateCache();
+	CHECK(dev.estimateConversionTime(0) == 4 * LTC298X_CYCLE_US_6050HZ);
+	CHECK(dev.estimateConversionTime(LTC298X_CH1, LTC298X_REJECT_50HZ, 100) == 2 * (LTC298X_CYCLE_US_50HZ + 1000));
+}
+
+#if LTC298X_INSTRUMENTATION
+/*
+ * Every scan is counted once, from INTERRUPT or from polling, with its latency and the status bits of its results
+ */
+static void testStats(void) {
+	LTC298XSim chip(TEST_CS, TEST_IRQ);
+	LTC298XSPITransport bus(TEST_CS);
+	LTC298XDevice dev(bus, TEST_IRQ);
+	LTC298XDevice polled(bus);
+	dev.begin();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupDiode(4, true, false, false, DIODE_CURRENT_10uA);
+	chip.injectFault(4, LTC298X_ERR_OVERRANGE);
+	chip.setConversionTime(1, 100000);
+	chip.setConversionTime(4, 100000);
+	dev.resetStats();
+	polled.resetStats();
+	int32_t raw[20];
+	uint8_t status[20];
+	for (uint8_t i = 0; i < 3; i++) {
+		dev.startScan(LTC298X_CH1 | LTC298X_CH4);
+		while (!dev.poll(raw, status)) delay(1);
+		polled.startScan(LTC298X_CH1 | LTC298X_CH4);
+		while (!polled.poll(raw, status)) delay(1);
+	}
+	LTC298XStats stats = dev.getStats();
+	CHECK(stats.conversions == 3 && polled.getStats().conversions == 3);
+	CHECK(stats.latency_min >= 200000 && stats.latency_max < 201000); //done seen at INTERRUPT
+	CHECK(dev.getMeanLatency() >= stats.latency_min && dev.getMeanLatency() <= stats.latency_max);
+	CHECK(polled.getStats().latency_max < 202000);
+	CHECK(stats.valid[0] == 3 && stats.faults[3][2] == 3 && stats.transactions > 0);
+	dev.resetStats();
+	stats = dev.getStats();
+	CHECK(!stats.conversions && !stats.transactions && dev.getMeanLatency() == 0);
+}
+#endif
+
+/*
+ * The tuner picks the fastest setting within budget for an input that settles slowly,
+ * falls back to the reference setting if none fits and applies stored results
+ */
+static void testTuner(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupDiode(2, true, false, false, DIODE_CURRENT_10uA);
+	chip.setValue(1, 25 * 1024);
+	chip.setValue(2, 30 * 1024);
+	chip.setSettling(2, 10000, 200); //settled within budget from 1.25 ms MUX delay on
+	LTC298XTuner tuner(dev);
+	LTC298XTuning tuning;
+	CHECK(tuner.tune(LTC298X_CH1 | LTC298X_CH2, 20, &tuning));
+	CHECK(tuning.version == LTC298X_TUNING_VERSION && tuning.reject == LTC298X_REJECT_60HZ && tuning.mux_delay == 200);
+	CHECK(tuning.noise <= 20 && tuning.conversion_us == dev.estimateConversionTime(LTC298X_CH1 | LTC298X_CH2, LTC298X_REJECT_60HZ, 200));
+	CHECK(chip.peek8(0x0FF) == 200 && (chip.peek8(0x0F0) & 0x03) == LTC298X_REJECT_60HZ);
+	//noise above budget for every setting
+	chip.setNoise(1, 1000);
+	tuner.setSamples(4);
+	CHECK(!tuner.tune(LTC298X_CH1 | LTC298X_CH2, 20, &tuning));
+	CHECK(tuning.reject == LTC298X_REJECT_6050HZ && tuning.mux_delay == 255 && tuning.noise > 20);
+	CHECK(chip.peek8(0x0FF) == 255 && (chip.peek8(0x0F0) & 0x03) == LTC298X_REJECT_6050HZ);
+	//reference can't be measured
+	chip.injectFault(1, LTC298X_ERR_SEN_HARDFAIL);
+	CHECK(!tuner.tune(LTC298X_CH1, 20, &tuning) && tuning.noise == 0xFFFFFFFF);
+	CHECK(!tuner.tune(0, 20, &tuning));
+	//stored results
+	LTC298XTuning stored = {LTC298X_TUNING_VERSION, LTC298X_REJECT_50HZ, 20, 0, 0};
+	CHECK(LTC298XTuner::apply(dev, stored));
+	CHECK(chip.peek8(0x0FF) == 20 && (chip.peek8(0x0F0) & 0x03) == LTC298X_REJECT_50HZ);
+	stored.version++;
+	stored.mux_delay = 50;
+	CHECK(!LTC298XTuner::apply(dev, stored) && chip.peek8(0x0FF) == 20);
+}
+
+/*
+ * Results reach the callback when they leave the deadband, change status or the heartbeat is due
+ */
+static uint32_t reported;
+static void reportedSamples(uint32_t mask, const int32_t*, const uint8_t*) {
+	reported = mask;
+}
+static uint32_t reportScan(LTC298XDevice& dev) {
+	reported = 0;
+	dev.startScan();
+	while (!dev.poll()) delay(1);
+	return reported;
+}
+static void testReporter(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	LTC298XReporter reporter;
+	dev.begin();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupDiode(2, true, false, false, DIODE_CURRENT_10uA);
+	dev.selectConversionChannels(LTC298X_CH1 | LTC298X_CH2);
+	dev.onScanComplete(reportedSamples);
+	dev.setReporter(&reporter);
+	CHECK(reporter.setDeadband(1, 102, 5000) && reporter.setDeadband(2, 0, 0) && !reporter.setDeadband(21, 0, 0));
+	chip.setValue(1, 25 * 1024);
+	chip.setValue(2, 30 * 1024);
+	CHECK(reportScan(dev) == (LTC298X_CH1 | LTC298X_CH2)); //first results
+	CHECK(reportScan(dev) == 0);
+	chip.setValue(1, 25 * 1024 + 102);
+	CHECK(reportScan(dev) == 0); //within the deadband
+	chip.setValue(1, 25 * 1024 + 103);
+	chip.setValue(2, 30 * 1024 + 1);
+	CHECK(reportScan(dev) == (LTC298X_CH1 | LTC298X_CH2));
+	chip.setValue(1, 25 * 1024 + 1);
+	CHECK(reportScan(dev) == 0); //reference moved with the last report
+	chip.injectFault(2, LTC298X_ERR_OUTOFRANGE);
+	CHECK(reportScan(dev) == LTC298X_CH2);
+	chip.injectFault(2, 0);
+	CHECK(reportScan(dev) == LTC298X_CH2);
+	delay(5000);
+	CHECK(reportScan(dev) == LTC298X_CH1); //heartbeat
+	reporter.reset();
+	CHECK(reportScan(dev) == (LTC298X_CH1 | LTC298X_CH2));
+	//results far apart don't overflow the difference
+	int32_t raw[20];
+	uint8_t status[20] = {0x01};
+	CHECK(reporter.setDeadband(1, 16777214, 0));
+	reporter.reset();
+	raw[0] = -8388608;
+	CHECK(reporter.update(LTC298X_CH1, raw, status, 0) == LTC298X_CH1);
+	raw[0] = 8388607;
+	CHECK(reporter.update(LTC298X_CH1, raw, status, 0) == LTC298X_CH1);
+}
+
+/*
+ * A fitted PT100 table and Steinhart-Hart coefficients stay within their budget and upload to the chip
+ */
+static void testCurveFit(void) {
+	const uint16_t n = 161;
+	double ohm[n], kelvin[n];
+	for (uint16_t i = 0; i < n; i++) {
+		double t = -200.0 + i * 5; //Callendar-Van Dusen, IEC 60751
+		double r = 1 + 3.9083e-3 * t - 5.775e-7 * t * t;
+		if (t < 0) r += -4.183e-12 * (t - 100) * t * t * t;
+		ohm[i] = 100 * r;
+		kelvin[i] = t + 273.15;
+	}
+	double x_table[LTC298X_FIT_MAX_ROWS], kelvin_table[LTC298X_FIT_MAX_ROWS];
+	uint16_t work[2 * n];
+	uint8_t rows = LTC298XCurveFit::fitTable(ohm, kelvin, n, LTC298X_FIT_RTD, 0.1, x_table, kelvin_table, LTC298X_FIT_MAX_ROWS, work);
+	CHECK(rows >= 3 && rows < 20 && x_table[0] == ohm[0] && x_table[rows - 1] == ohm[n - 1]);
+	CHECK(LTC298XCurveFit::tableError(ohm, kelvin, n, LTC298X_FIT_RTD, x_table, kelvin_table, rows) <= 0.1);
+	double x_tight[LTC298X_FIT_MAX_ROWS], kelvin_tight[LTC298X_FIT_MAX_ROWS];
+	uint8_t tight = LTC298XCurveFit::fitTable(ohm, kelvin, n, LTC298X_FIT_RTD, 0.01, x_tight, kelvin_tight, LTC298X_FIT_MAX_ROWS, work);
+	CHECK(tight > rows && LTC298XCurveFit::tableError(ohm, kelvin, n, LTC298X_FIT_RTD, x_tight, kelvin_tight, tight) <= 0.01);
+	CHECK(LTC298XCurveFit::fitTable(ohm, kelvin, n, LTC298X_FIT_RTD, 0.01, x_tight, kelvin_tight, tight - 1, work) == 0);
+	CHECK(LTC298XCurveFit::fitTable(ohm, kelvin, n, LTC298X_FIT_RTD, 1e-5, x_tight, kelvin_tight, LTC298X_FIT_MAX_ROWS, work) == 0); //below 1/1024 K
+	//a straight line still needs 3 rows
+	double line_x[10], line_k[10];
+	for (uint8_t i = 0; i < 10; i++) {
+		line_x[i] = 100 + i * 10;
+		line_k[i] = 273 + i * 25;
+	}
+	CHECK(LTC298XCurveFit::fitTable(line_x, line_k, 10, LTC298X_FIT_RTD, 0.01, x_tight, kelvin_tight, LTC298X_FIT_MAX_ROWS, work) == 3);
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupSenseResistor(2, 2000);
+	CHECK(dev.setupCustomRTD(5, 2, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x_table, kelvin_table, rows));
+	CHECK(chip.peek32(0x200 + 4 * 4) >> 27 == LTC298X_TYPE_RTD_CUST && (chip.peek32(0x200 + 4 * 4) & 0x3F) == (uint32_t)rows - 1);
+	//10k NTC, 1/T = A + B ln R + D ln³ R
+	const double a = 1.129148e-3, b = 2.34125e-4, d = 8.76741e-8;
+	double ntc_ohm[n], ntc_kelvin[n], sh_work[7 * n];
+	for (uint16_t i = 0; i < n; i++) {
+		ntc_ohm[i] = 100 * pow(10000.0, i / (double)(n - 1)); //100 ohm to 1 Mohm
+		double ln = log(ntc_ohm[i]);
+		ntc_kelvin[i] = 1 / (a + b * ln + d * ln * ln * ln);
+	}
+	float coeff[6];
+	double error = LTC298XCurveFit::fitSteinhartHart(ntc_ohm, ntc_kelvin, n, LTC298X_FIT_SH_CLASSIC, coeff, sh_work);
+	CHECK(error >= 0 && error < 0.01);
+	CHECK(fabs(coeff[0] - a) < a * 1e-3 && fabs(coeff[1] - b) < b * 1e-3 && coeff[2] == 0 && fabs(coeff[3] - d) < d * 1e-2);
+	CHECK(fabs(LTC298XCurveFit::steinhartHart(coeff, 10000) - 298.15) < 0.01);
+	CHECK(LTC298XCurveFit::fitSteinhartHart(ntc_ohm, ntc_kelvin, 2, LTC298X_FIT_SH_CLASSIC, coeff, sh_work) < 0);
+	CHECK(dev.setupSteinhartHartThermistor(19, 2, true, LTC298X_MODE_NONE, TR_CURRENT_AUTO, coeff));
+	CHECK(chip.peek32(0x200 + 18 * 4) >> 27 == LTC298X_TYPE_THER_STEINH);
+}
+
+/*
+ * Linearized ADC results match the NIST tables and Callendar-Van Dusen, clamp at the curve ends
+ * and compensate the cold junction through toInput()
+ */
+static int32_t millivolts(double mV) {
+	return (int32_t)lround(mV * 2097.152);
+}
+static void testLinearizer(void) {
+	typedef LTC298XThermocoupleCurve<LTC298X_TYPE_TC_K> TypeK;
+	LTC298XLinearizer tc = LTC298XLinearizer::of<TypeK>();
+	const double nist[][2] = {{-5.891, -200}, {-3.554, -100}, {0, 0}, {4.096, 100}, {20.644, 500}, {41.276, 1000}, {54.886, 1372}};
+	bool exact = true;
+	for (uint8_t i = 0; i < 7; i++) {
+		if (labs(tc.convert(millivolts(nist[i][0])) - (int32_t)(nist[i][1] * 1024)) > 103) exact = false; //0.1 °C
+	}
+	CHECK(exact);
+	//clamped to the ends of the curve, not of the grid around it
+	CHECK(tc.convert(millivolts(80)) == tc.convert(INT32_MAX / 2) && labs(tc.convert(INT32_MAX / 2) - 1372 * 1024) <= 103);
+	CHECK(tc.convert(millivolts(-10)) == tc.convert(-INT32_MAX / 2) && labs(tc.convert(-INT32_MAX / 2) + 200 * 1024) <= 103);
+	CHECK(labs(tc.toInput(2000 * 1024) - millivolts(54.886)) <= 1 && labs(tc.toInput(-300 * 1024) - millivolts(-5.891)) <= 1);
+	int32_t cj = tc.toInput(25 * 1024);
+	CHECK(labs(cj - millivolts(1.000)) <= 3 && labs(tc.convert(cj) - 25 * 1024) <= 8);
+	typedef LTC298XRTDCurve<RTD_CURVE_EUROPEAN> PT;
+	LTC298XLinearizer rtd = LTC298XLinearizer::of<PT>();
+	CHECK(labs(rtd.convert(2097152) - 0) <= 2 && labs(rtd.convert(lround(1.38506 * 2097152)) - 100 * 1024) <= 10);
+	CHECK(labs(rtd.convert(lround(0.60256 * 2097152)) + 100 * 1024) <= 10);
+	//ADC channels read from the chip, cold junction at 25 °C
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupADC(4, true);
+	dev.setupADC(5, true);
+	dev.setupADC(6, true);
+	chip.setValue(4, millivolts(4.096 - 1.000));
+	chip.setValue(5, millivolts(20.644 - 1.000));
+	chip.setValue(6, millivolts(2));
+	chip.injectFault(6, LTC298X_ERR_SEN_HARDFAIL);
+	const uint32_t mask = LTC298X_CH4 | LTC298X_CH5 | LTC298X_CH6;
+	int32_t raw[20];
+	uint8_t status[20];
+	dev.startScan(mask);
+	while (!dev.poll(raw, status)) delay(1);
+	int32_t failed = raw[5];
+	tc.apply(mask, raw, status, cj);
+	CHECK(labs(raw[3] - 100 * 1024) <= 103 && labs(raw[4] - 500 * 1024) <= 103 && raw[5] == failed);
+	int32_t inputs[2] = {millivolts(3.096), millivolts(19.644)};
+	tc.convert(inputs, inputs, 2, cj);
+	CHECK(inputs[0] == raw[3] && inputs[1] == raw[4]);
+}
+
+/*
+ * Destroyed devices free their interrupt handler, INTERRUPT edges don't reach them afterwards
+ */
+static void testIrqRelease(void) {
+	LTC298XSim chip(TEST_CS, TEST_IRQ);
+	LTC298XSPITransport bus(TEST_CS);
+	for (uint8_t i = 0; i <= LTC298X_MAX_IRQ_DEVICES; i++) {
+		LTC298XDevice gone(bus, TEST_IRQ);
+		gone.begin();
+	}
+	hostSetPin(TEST_IRQ, LOW);
+	hostSetPin(TEST_IRQ, HIGH);
+	LTC298XDevice dev(bus, TEST_IRQ);
+	dev.begin();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.startScan(LTC298X_CH1);
+	chip.resetStats();
+	int32_t raw[20];
+	uint8_t status[20];
+	while (!dev.poll(raw, status)) delay(1);
+	CHECK(chip.stats.reads == 1); //done from INTERRUPT, only the results are read
+	dev.end();
+	dev.startScan(LTC298X_CH1);
+	while (!dev.poll(raw, status)) delay(1);
+	CHECK(chip.stats.reads > 2); //polled again
+}
+
+/*
+ * Channels are sampled at their own period, channels due together share a scan
+ */
+static uint16_t scheduled[20];
+static uint16_t scheduled_joint;
+static uint16_t scheduled_scans;
+static void scheduledSamples(uint32_t mask, const int32_t*, const uint8_t* status) {
+	for (uint8_t i = 0; i < 20; i++) {
+		if ((mask & ((uint32_t)1 << i)) && (status[i] & 0x01)) scheduled[i]++;
+	}
+	if ((mask & LTC298X_CH1) && (mask & LTC298X_CH4)) scheduled_joint++;
+	scheduled_scans++;
+}
+static void testScheduler(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298X dev(TEST_CS);
+	dev.begin();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupThermocouple(4, LTC298X_TYPE_TC_K, 1, true);
+	chip.setConversionTime(1, 10000);
+	chip.setConversionTime(4, 10000);
+	LTC298XScheduler scheduler(dev);
+	CHECK(!scheduler.setPeriod(21, 100));
+	CHECK(scheduler.setPeriod(1, 100) && scheduler.setPeriod(4, 300));
+	scheduler.onSamples(scheduledSamples);
+	for (uint16_t t = 0; t < 1000; t++) {
+		scheduler.update();
+		delay(1);
+	}
+	CHECK(scheduled[0] >= 9 && scheduled[0] <= 10);
+	CHECK(scheduled[3] == 4 && scheduled_joint == 4);
+	CHECK(scheduled_scans == scheduled[0] + scheduled[3] - scheduled_joint);
+	CHECK(chip.stats.conversions - scheduled_scans <= 1); //the last scan may still be running
+	scheduler.setPeriod(4, 0);
+	for (uint16_t t = 0; t < 500; t++) {
+		scheduler.update();
+		delay(1);
+	}
+	CHECK(scheduled[3] == 4 && scheduled[0] >= 14);
+}
+
+/*
+ * Group starts are staggered, every chip keeps reporting
+ */
+static uint8_t group_results[2];
+static void groupResult(uint8_t device, uint32_t, const int32_t* raw, const uint8_t*) {
+	if (raw[3] == (device + 1) * 1024) group_results[device]++;
+}
+static void testGroup(void) {
+	LTC298XSim chip0(TEST_CS);
+	LTC298XSim chip1(TEST_CS + 1);
+	LTC298XSPIBus spi;
+	LTC298XSPITransport bus0(TEST_CS, spi);
+	LTC298XSPITransport bus1(TEST_CS + 1, spi);
+	LTC298XDevice dev0(bus0);
+	LTC298XDevice dev1(bus1);
+	LTC298XGroup group(spi);
+	group.add(dev0, LTC298X_CH1 | LTC298X_CH4);
+	group.add(dev1, LTC298X_CH1 | LTC298X_CH4);
+	group.begin();
+	LTC298XDevice* devs[2] = {&dev0, &dev1};
+	for (uint8_t i = 0; i < 2; i++) {
+		devs[i]->setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+		devs[i]->setupThermocouple(4, LTC298X_TYPE_TC_K, 1, true);
+	}
+	chip0.setValue(4, 1024);
+	chip1.setValue(4, 2048);
+	group.onScanComplete(groupResult);
+	chip0.resetStats();
+	chip1.resetStats();
+	group.start();
+	CHECK(chip0.stats.conversions == 1 && chip1.stats.conversions == 0);
+	for (uint16_t t = 0; t < 3000; t++) {
+		group.update();
+		delay(1);
+	}
+	CHECK(chip1.stats.conversions > 0);
+	CHECK(group_results[0] >= 5 && group_results[1] >= 5);
+}
+
+/*
+ * The spidev backend batches transactions into messages and keeps them intact
+ */
+static void testSpidev(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298XSpidevSim bus(TEST_CS);
+	LTC298XDevice dev(bus);
+	dev.begin();
+	bus.queueWrites(true);
+	uint32_t messages = bus.messages();
+	dev.beginConfig();
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.setupThermocouple(4, LTC298X_TYPE_TC_K, 1, true);
+	dev.commitConfig();
+	bus.flush();
+	CHECK(bus.messages() - messages == 1); //both bursts in one message
+	CHECK(chip.peek32(0x200 + 3 * 4) >> 27 == LTC298X_TYPE_TC_K);
+	chip.setValue(4, 100 * 1024);
+	dev.startScan(LTC298X_CH1 | LTC298X_CH4);
+	bus.flush();
+	int32_t raw[20];
+	uint8_t status[20];
+	while (!dev.poll(raw, status)) delay(10);
+	CHECK(raw[3] == 100 * 1024 && (status[3] & 0x01));
+	CHECK(!bus.failed());
+}
+
+/*
+ * A queue filling up exactly at a transaction boundary doesn't keep CS asserted
+ */
+static void testSpidevBoundary(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298XSpidevSim bus(TEST_CS);
+	LTC298XDevice dev(bus);
+	dev.begin();
+	bus.queueWrites(true);
+	for (uint8_t i = 1; i <= 33; i++) dev.setMuxDelay(i); //32 writes fill bufsiz
+	bus.flush();
+	CHECK(chip.peek8(0x0FF) == 33);
+	CHECK(!chip.peek8(0x100) && !chip.peek8(0x102) && !chip.peek8(0x103));
+	CHECK(!bus.failed());
+}
+
+/*
+ * Queued writes are split into messages within bufsiz as the kernel counts it,
+ * a failed message is reported by error() and leaves no valid results behind
+ */
+static void testSpidevBatch(void) {
+	LTC298XSim chip(TEST_CS);
+	LTC298XSpidevSim bus(TEST_CS);
+	LTC298XDevice dev(bus);
+	dev.begin();
+	bus.queueWrites(true);
+	double x[60];
+	double kelvin[60];
+	for (uint8_t i = 0; i < 60; i++) {
+		x[i] = 10 + i * 5;
+		kelvin[i] = 200 + i * 5;
+	}
+	uint32_t messages = bus.messages();
+	dev.setupCustomRTD(8, 3, 2, LTC298X_MODE_NONE, RTD_CURRENT_100uA, x, kelvin, 60);
+	for (uint8_t i = 1; i <= 100; i++) dev.setMuxDelay(i);
+	bus.flush();
+	CHECK(!bus.failed() && bus.error() == 0);
+	CHECK(bus.messages() - messages <= 5);
+	CHECK(chip.peek8(0x0FF) == 100 && chip.peek32(0x200 + 7 * 4) >> 27 == LTC298X_TYPE_RTD_CUST);
+	chip.setValue(1, 25 * 1024);
+	dev.setupDiode(1, true, false, false, DIODE_CURRENT_10uA);
+	dev.startScan(LTC298X_CH1);
+	bus.flush();
+	delay(1000);
+	int32_t raw[20];
+	uint8_t status[20];
+	bus.failNext(EIO);
+	CHECK(!dev.poll(raw, status)); //command register reads as busy
+	CHECK(bus.error() == EIO && bus.failed());
+	CHECK(dev.poll(raw, status) && bus.error() == 0 && raw[0] == 25 * 1024);
+	bus.failNext(EIO);
+	dev.readResults(LTC298X_CH1, raw, status);
+	CHECK(bus.error() == EIO && !(status[0] & 0x01));
+}
+
+/*
+ * Ring capacity is rounded down to a power of two, capacity 0 drops everything
+ */
+static void testRing(void) {
+	LTC298XSample buf[6];
+	LTC298XRing ring(buf, 6);
+	CHECK(ring.capacity() == 4);
+	LTC298XSample sample = {0, 0, 1, 0x01};
+	for (uint8_t i = 0; i < 5; i++) {
+		sample.raw = i;
+		ring.push(sample);
+	}
+	LTC298XSample out[6];
+	CHECK(ring.dropped() == 1 && ring.pop(out, 6) == 4 && out[3].raw == 3);
+	LTC298XRing empty(buf, 0);
+	CHECK(empty.capacity() == 0 && !empty.push(sample) && empty.available() == 0);
+}
+
+/*
+ * The moving average settles exactly on a constant input for every shift
+ */
+static void testEma(void) {
+	const uint8_t shifts[] = {0, 6, 8, 12, 16};
+	for (uint8_t i = 0; i < sizeof(shifts); i++) {
+		LTC298XEmaFilter up(shifts[i]), down(shifts[i]);
+		up.update(0);
+		down.update(0);
+		int32_t y_up = 0, y_down = 0;
+		for (uint32_t n = 0; n < 2000000; n++) {
+			y_up = up.update(25600);
+			y_down = down.update(-25600);
+		}
+		CHECK(y_up == 25600 && y_down == -25600);
+	}
+}
+
+/*
+ * The Kalman filter follows a step without overshoot and settles on it, also between the limits of the 24 bit range
+ */
+static void testKalman(void) {
+	const int32_t steps[][2] = {{0, 25600}, {25600, -25600}, {8388607, -8388608}, {-8388608, 8388607}};
+	for (uint8_t i = 0; i < 4; i++) {
+		LTC298XKalmanFilter filter(16, 4096);
+		int32_t from = steps[i][0], to = steps[i][1];
+		CHECK(filter.update(from) == from);
+		int32_t y = from;
+		bool monotonic = true;
+		for (uint16_t n = 0; n < 1000; n++) {
+			int32_t next = filter.update(to);
+			if (to > from ? next < y || next > to : next > y || next < to) monotonic = false;
+			y = next;
+		}
+		CHECK(monotonic && y == to);
+	}
+	LTC298XKalmanFilter filter(0, 100);
+	filter.update(1000);
+	filter.update(2000);
+	CHECK(filter.update(1000) < 2000); //gain drops as the variance shrinks
+	filter.reset();
+	CHECK(filter.update(-5) == -5);
+}
+
+/*
+ * An even window reports the mean of its two middle samples, also while filling and after the oldest sample left
+ */
+static void testMedian(void) {
+	LTC298XMedianFilter<4> filter;
+	CHECK(filter.update(10) == 10);
+	CHECK(filter.update(40) == 25);
+	CHECK(filter.update(20) == 20);
+	CHECK(filter.update(30) == 25);
+	CHECK(filter.update(100) == 35); //10 left: 20 30 40 100
+	CHECK(filter.update(-100) == 25); //40 left: -100 20 30 100
+	CHECK(filter.update(20) == 25); //20 replaced by an equal sample: -100 20 30 100
+	filter.reset();
+	CHECK(filter.update(8388607) == 8388607 && filter.update(8388607) == 8388607);
+	CHECK(filter.update(-8388608) == 8388607 && filter.update(-8388608) == 0); //mean of -8388608 and 8388607 rounds to 0
+}
+
+/*
+ * Frames decode to the encoded results, delta frames included, corrupted frames are rejected
+ */
+static void testFrames(void) {
+	LTC298XFrameEncoder encoder(4);
+	LTC298XFrameDecoder decoder;
+	int32_t raw[20];
+	uint8_t status[20];
+	uint8_t buf[LTC298X_FRAME_MAX];
+	uint32_t mask = LTC298X_CH1 | LTC298X_CH4 | LTC298X_CH20;
+	bool all_equal = true;
+	for (uint8_t n = 0; n < 10; n++) {
+		for (uint8_t i = 0; i < 20; i++) {
+			raw[i] = (i - 10) * 1000 + n * (i & 1 ? 3 : -7);
+			status[i] = i == 3 && n == 5 ? LTC298X_ERR_OVERRANGE : 0x01;
+		}
+		raw[19] = n & 1 ? 8388607 : -8388608; //full range swings
+		uint8_t len = encoder.encode(mask, raw, status, buf);
+		uint32_t got_mask = 0;
+		int32_t got[20];
+		uint8_t got_status[20];
+		if (!decoder.decode(buf, len, &got_mask, got, got_status) || got_mask != mask) {
+			all_equal = false;
+			continue;
+		}
+		for (uint8_t i = 0; i < 20; i++) {
+			if (!(mask & ((uint32_t)1 << i))) continue;
+			if (got[i] != raw[i] || got_status[i] != status[i]) all_equal = false;
+		}
+	}
+	CHECK(all_equal);
+	uint8_t len = encoder.encode(mask, raw, status, buf);
+	buf[len - 3] ^= 0x01;
+	uint32_t got_mask;
+	int32_t got[20];
+	CHECK(!decoder.decode(buf, len, &got_mask, got, status));
+}
+
+int main(void) {
+	testResults();
+	testStaging();
+	testAllocator();
+	testTableUpdate();
+	testRows();
+	testConfigImage();
+	testImage();
+	testConversionTime();
+#if LTC298X_INSTRUMENTATION
+	testStats();
+#endif
+	testTuner();
+	testReporter();
+	testCurveFit();
+	testLinearizer();
+	testIrqRelease();
+	testScheduler();
+	testGroup();
+	testSpidev();
+	testSpidevBoundary();
+	testSpidevBatch();
+	testRing();
+	testEma();
+	testKalman();
+	testMedian();
+	testFrames();
+	printf("%u checks, %u failed\n", checks, failures);
+	return failures ? 1 : 0;
+}